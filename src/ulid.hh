@@ -2,11 +2,13 @@
 #define ULID_HH
 
 // http://stackoverflow.com/a/23981011
-#ifdef __SIZEOF_INT128__
+#if defined(__SIZEOF_INT128__) && !defined(ULIDU64PAIR)
 #define ULIDUINT128
 #endif
 
-#ifdef ULIDUINT128
+#if defined(ULIDU64PAIR)
+#include "ulid_u64pair.hh"
+#elif defined(ULIDUINT128)
 #include "ulid_uint128.hh"
 #else
 #include "ulid_struct.hh"
@@ -0,0 +1,364 @@
+#ifndef ULID_API_HH
+#define ULID_API_HH
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <random>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "ulid_column.hh"
+#include "ulid_core.hh"
+#include "ulid_counter.hh"
+#include "ulid_dedup.hh"
+#include "ulid_dispenser.hh"
+#include "ulid_file.hh"
+#include "ulid_flat.hh"
+#include "ulid_index.hh"
+#include "ulid_partition.hh"
+#include "ulid_sort.hh"
+#include "ulid_stream.hh"
+
+/**
+ * The API for the default ulid::ULID, the representation of whichever of
+ * ulid_uint128.hh, ulid_u64pair.hh or ulid_struct.hh was included first. Each
+ * function forwards to its namespace core template of the same name, see
+ * ulid_core.hh for what they do.
+ * */
+
+namespace ulid {
+
+static_assert(IsULID<ULID>::value, "include ulid_uint128.hh, ulid_u64pair.hh or ulid_struct.hh instead");
+
+// Encoding
+
+inline constexpr void EncodeTime(time_t timestamp, ULID& ulid) {
+    core::EncodeTime(timestamp, ulid);
+}
+
+template <class Clock>
+inline void EncodeTimeNow(Clock&& clock, ULID& ulid) {
+    core::EncodeTimeNow(clock, ulid);
+}
+
+inline void EncodeTimeNow(ULID& ulid) {
+    core::EncodeTimeNow(ulid);
+}
+
+inline void EncodeTimeSystemClockNow(ULID& ulid) {
+    core::EncodeTimeSystemClockNow(ulid);
+}
+
+inline void EncodeEntropy(const std::function<uint8_t()>& rng, ULID& ulid) {
+    core::EncodeEntropy(rng, ulid);
+}
+
+template <class Rng>
+inline void EncodeEntropy(Rng&& rng, ULID& ulid) {
+    core::EncodeEntropy(rng, ulid);
+}
+
+inline void EncodeEntropyRand(ULID& ulid) {
+    core::EncodeEntropyRand(ulid);
+}
+
+inline void EncodeEntropyMt19937(std::mt19937& generator, ULID& ulid) {
+    core::EncodeEntropyMt19937(generator, ulid);
+}
+
+inline void EncodeEntropyMt19937(ULID& ulid) {
+    core::EncodeEntropyMt19937(ulid);
+}
+
+inline void EncodeEntropySecure(ULID& ulid) {
+    core::EncodeEntropySecure(ulid);
+}
+
+inline void Encode(time_t timestamp, const std::function<uint8_t()>& rng, ULID& ulid) {
+    core::Encode(timestamp, rng, ulid);
+}
+
+template <class Rng>
+inline void Encode(time_t timestamp, Rng&& rng, ULID& ulid) {
+    core::Encode(timestamp, rng, ulid);
+}
+
+inline void GenerateNow(ULID& ulid) {
+    core::GenerateNow(ulid);
+}
+
+inline void GenerateNow(std::mt19937& generator, ULID& ulid) {
+    core::GenerateNow(generator, ulid);
+}
+
+inline void EncodeNowRand(ULID& ulid) {
+    core::EncodeNowRand(ulid);
+}
+
+// Creation
+
+inline ULID Create(time_t timestamp, const std::function<uint8_t()>& rng) {
+    return core::Create<ULID>(timestamp, rng);
+}
+
+template <class Rng>
+inline ULID Create(time_t timestamp, Rng&& rng) {
+    return core::Create<ULID>(timestamp, rng);
+}
+
+inline ULID CreateNowRand() {
+    return core::CreateNowRand<ULID>();
+}
+
+inline constexpr ULID MinULID(time_t timestamp) {
+    return core::MinULID<ULID>(timestamp);
+}
+
+inline constexpr ULID MaxULID(time_t timestamp) {
+    return core::MaxULID<ULID>(timestamp);
+}
+
+template <class Clock, class Rng>
+inline void GenerateBatch(Clock&& clock, Rng&& rng, ULID* out, size_t n) {
+    core::GenerateBatch(clock, rng, out, n);
+}
+
+template <class Rng>
+inline void GenerateBatch(Rng&& rng, ULID* out, size_t n) {
+    core::GenerateBatch(rng, out, n);
+}
+
+inline void GenerateBatch(ULID* out, size_t n) {
+    core::GenerateBatch(out, n);
+}
+
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L
+inline void GenerateBatch(std::span<ULID> out) {
+    core::GenerateBatch(out.data(), out.size());
+}
+#endif
+
+// Marshaling
+
+inline constexpr void MarshalToScalar(const ULID& ulid, char dst[26]) {
+    core::MarshalToScalar(ulid, dst);
+}
+
+inline constexpr void MarshalTo(const ULID& ulid, char dst[26]) {
+    core::MarshalTo(ulid, dst);
+}
+
+inline void MarshalBatch(const ULID* ulids, size_t n, char* dst) {
+    core::MarshalBatch(ulids, n, dst);
+}
+
+inline void MarshalToHuman(const ULID& ulid, char dst[36]) {
+    core::MarshalToHuman(ulid, dst);
+}
+
+inline std::string MarshalHuman(const ULID& ulid) {
+    return core::MarshalHuman(ulid);
+}
+
+inline std::string Marshal(const ULID& ulid) {
+    return core::Marshal(ulid);
+}
+
+inline std::array<char, 26> MarshalArray(const ULID& ulid) {
+    return core::MarshalArray(ulid);
+}
+
+inline void MarshalBinaryTo(const ULID& ulid, uint8_t dst[16]) {
+    core::MarshalBinaryTo(ulid, dst);
+}
+
+inline std::vector<uint8_t> MarshalBinary(const ULID& ulid) {
+    return core::MarshalBinary(ulid);
+}
+
+inline std::array<uint8_t, 16> MarshalBinaryArray(const ULID& ulid) {
+    return core::MarshalBinaryArray(ulid);
+}
+
+// Unmarshaling
+
+inline constexpr void UnmarshalFrom(const char str[26], ULID& ulid) {
+    core::UnmarshalFrom(str, ulid);
+}
+
+inline ULID Unmarshal(std::string_view str) {
+    return core::Unmarshal<ULID>(str);
+}
+
+inline void UnmarshalHumanFrom(const char str[36], ULID& ulid) {
+    core::UnmarshalHumanFrom(str, ulid);
+}
+
+inline ULID UnmarshalHuman(const std::string& str) {
+    return core::UnmarshalHuman<ULID>(str);
+}
+
+inline Status TryUnmarshalFrom(const char str[26], ULID& ulid) {
+    return core::TryUnmarshalFrom(str, ulid);
+}
+
+inline Status TryUnmarshal(std::string_view str, ULID& ulid) {
+    return core::TryUnmarshal(str, ulid);
+}
+
+inline size_t TryUnmarshalBatch(const char* src, size_t n, size_t stride, ULID* out) {
+    return core::TryUnmarshalBatch(src, n, stride, out);
+}
+
+inline size_t TryUnmarshalLines(const char* src, size_t len, ULID* out, size_t n, size_t* consumed) {
+    return core::TryUnmarshalLines(src, len, out, n, consumed);
+}
+
+inline void UnmarshalBinaryFrom(const uint8_t b[16], ULID& ulid) {
+    core::UnmarshalBinaryFrom(b, ulid);
+}
+
+inline ULID UnmarshalBinary(const std::vector<uint8_t>& b) {
+    return core::UnmarshalBinary<ULID>(b);
+}
+
+inline ULID UnmarshalBinary(const uint8_t (&b)[16]) {
+    return core::UnmarshalBinary<ULID>(b);
+}
+
+inline ULID UnmarshalBinary(const std::array<uint8_t, 16>& b) {
+    return core::UnmarshalBinary<ULID>(b);
+}
+
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L
+inline ULID UnmarshalBinary(std::span<const uint8_t, 16> b) {
+    return core::UnmarshalBinary<ULID>(b);
+}
+#endif
+
+namespace literals {
+
+/**
+ * "01ARZ3NDEKTSV4RRFFQ69G5FAV"_ulid is the ULID with that string encoding,
+ * validated and decoded at compile time.
+ * */
+#if defined(ULID_LITERAL_TEMPLATE)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wgnu-string-literal-operator-template"
+#endif
+template <class C, C... chars>
+inline constexpr ULID operator""_ulid() {
+    static_assert(std::is_same<C, char>::value, "_ulid takes a narrow string literal");
+    static_assert(ValidLiteral(LiteralChars<C, chars...>::str, sizeof...(chars)),
+                  "a _ulid literal is 26 characters of the uppercase alphabet, starting at most with 7");
+    return core::Literal<ULID>(LiteralChars<C, chars...>::str, sizeof...(chars));
+}
+#pragma GCC diagnostic pop
+#else
+// without consteval or the template form (MSVC before C++20) a malformed
+// literal only fails to compile in a constexpr context, and aborts otherwise
+inline ULID_CONSTEVAL ULID operator""_ulid(const char* str, size_t len) {
+    return core::Literal<ULID>(str, len);
+}
+#endif
+
+};  // namespace literals
+
+// Comparison
+
+inline int CompareULIDs(const ULID& ulid1, const ULID& ulid2) {
+    return core::CompareULIDs(ulid1, ulid2);
+}
+
+inline constexpr time_t Time(const ULID& ulid) {
+    return core::Time(ulid);
+}
+
+// Sorting
+
+inline void Sort(ULID* ulids, size_t n, unsigned threads = 0) {
+    core::Sort(ulids, n, threads);
+}
+
+// Indexes
+
+typedef core::UlidIndex<ULID> UlidIndex;
+
+// Hash tables
+
+typedef core::Hash<ULID> Hash;
+
+typedef core::UlidFlatSet<ULID> UlidFlatSet;
+
+template <class T>
+using UlidFlatMap = core::UlidFlatMap<ULID, T>;
+
+typedef core::WindowedDeduper<ULID> WindowedDeduper;
+
+// Files
+
+#ifdef ULID_HAS_MMAP
+typedef core::MappedUlidFile<ULID> MappedUlidFile;
+#endif
+
+// Columns
+
+inline void ExtractTimes(const ULID* ulids, size_t n, int64_t* out) {
+    core::ExtractTimes(ulids, n, out);
+}
+
+inline size_t BucketCounts(const ULID* ulids, size_t n, int64_t bucket_ms, int64_t start_ms,
+                           uint64_t* counts, size_t buckets) {
+    return core::BucketCounts(ulids, n, bucket_ms, start_ms, counts, buckets);
+}
+
+// Partitions
+
+typedef core::EntropyLayout EntropyLayout;
+
+inline void EncodePartitionedEntropy(const EntropyLayout& layout, uint64_t node, uint64_t sequence, ULID& ulid) {
+    core::EncodePartitionedEntropy(layout, node, sequence, ulid);
+}
+
+template <class Rng>
+inline void EncodePartitionedEntropy(const EntropyLayout& layout, uint64_t node, uint64_t sequence,
+                                     Rng&& rng, ULID& ulid) {
+    core::EncodePartitionedEntropy(layout, node, sequence, rng, ulid);
+}
+
+inline constexpr uint64_t ExtractNode(const EntropyLayout& layout, const ULID& ulid) {
+    return core::ExtractNode(layout, ulid);
+}
+
+inline constexpr uint64_t ExtractSequence(const EntropyLayout& layout, const ULID& ulid) {
+    return core::ExtractSequence(layout, ulid);
+}
+
+// Generators
+
+template <class Clock>
+using BasicMonotonicGenerator = core::BasicMonotonicGenerator<ULID, Clock>;
+
+typedef BasicMonotonicGenerator<clocks::DefaultClock> MonotonicGenerator;
+
+template <class Clock>
+using BasicIdDispenser = core::BasicIdDispenser<ULID, Clock>;
+
+typedef BasicIdDispenser<clocks::DefaultClock> IdDispenser;
+
+template <class Clock>
+using BasicPartitionedGenerator = core::BasicPartitionedGenerator<ULID, Clock>;
+
+typedef BasicPartitionedGenerator<clocks::DefaultClock> PartitionedGenerator;
+
+typedef core::CounterGenerator<ULID> CounterGenerator;
+
+};  // namespace ulid
+
+#endif // ULID_API_HH
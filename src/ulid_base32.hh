@@ -0,0 +1,624 @@
+#ifndef ULID_BASE32_HH
+#define ULID_BASE32_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// The vector kernels are compiled per function with target attributes and picked
+// at runtime, so the default build flags keep working on any x86-64 machine.
+// MSVC has no target attributes, there they are only used under /arch:AVX2.
+// Define ULID_NO_SIMD to always use the scalar code.
+#if !defined(ULID_NO_SIMD) && (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define ULID_BASE32_SIMD
+#define ULID_TARGET_SSE41 __attribute__((target("ssse3,sse4.1")))
+#define ULID_TARGET_AVX2 __attribute__((target("avx2")))
+#elif !defined(ULID_NO_SIMD) && defined(_MSC_VER) && defined(__AVX2__)
+#include <immintrin.h>
+#define ULID_BASE32_SIMD
+#define ULID_TARGET_SSE41
+#define ULID_TARGET_AVX2
+#endif
+
+// ULID_IS_CONSTANT_EVALUATED() keeps the constexpr functions off the vector
+// kernels during constant evaluation. Compilers without a way to tell always
+// take the portable path.
+#if defined(__cpp_lib_is_constant_evaluated)
+#define ULID_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#elif defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define ULID_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+#elif (defined(__GNUC__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define ULID_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#endif
+
+#ifndef ULID_IS_CONSTANT_EVALUATED
+#define ULID_IS_CONSTANT_EVALUATED() true
+#endif
+
+// ULID_CONSTEVAL makes the _ulid literal an immediate function where the
+// compiler supports it, so it can never be evaluated at run time. Before
+// C++20, g++ and clang++ take the characters as template arguments instead
+// (ULID_LITERAL_TEMPLATE) and check them with a static_assert.
+#if defined(__cpp_consteval)
+#define ULID_CONSTEVAL consteval
+#else
+#define ULID_CONSTEVAL constexpr
+#if defined(__GNUC__)
+#define ULID_LITERAL_TEMPLATE 1
+#endif
+#endif
+
+namespace ulid {
+
+/**
+ * Status is the result of the checked (Try*) unmarshal functions.
+ * */
+enum class Status {
+    OK = 0,
+    InvalidLength,    // not 26 characters
+    InvalidCharacter, // not in Crockford's Base32
+    Overflow,         // first character above '7', the value does not fit in 128 bits
+};
+
+namespace base32 {
+
+/**
+ * HostLittleEndian tells whether a 128 bit integer is stored least significant byte first.
+ * */
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+inline constexpr bool HostLittleEndian = false;
+#else
+inline constexpr bool HostLittleEndian = true;
+#endif
+
+/**
+ * Level is the widest instruction set the Base32 kernels use on this machine.
+ * */
+enum Level {
+    LevelScalar = 0,
+    LevelSSE41 = 1,
+    LevelAVX2 = 2,
+};
+
+inline int DetectLevel() {
+#if defined(ULID_BASE32_SIMD) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return LevelAVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return LevelSSE41;
+    }
+    return LevelScalar;
+#elif defined(ULID_BASE32_SIMD)
+    return LevelAVX2;
+#else
+    return LevelScalar;
+#endif
+}
+
+/**
+ * SimdLevel returns DetectLevel, computed once per process.
+ * */
+inline int SimdLevel() {
+    static const int level = DetectLevel();
+    return level;
+}
+
+#ifdef ULID_BASE32_SIMD
+
+/**
+ * EncodeShuffle gathers the 16 bit window holding each output character.
+ *
+ * The 128 bit ULID is zero extended to 160 bits (4 zero bytes in front), which
+ * splits into 4 groups of 5 bytes = 8 characters, the last 26 of those 32
+ * characters being the encoded ULID. Character j of a group starts at bit 5j,
+ * i.e. in byte {0, 0, 1, 1, 2, 3, 3, 4}[j] of the group, and each 16 bit lane
+ * gets that byte as its high half and the next byte as its low half.
+ *
+ * 0x80 lanes are zeroed by pshufb. [0] is for big endian input (the byte order
+ * of MarshalBinaryTo), [1] for a little endian 128 bit integer.
+ * */
+alignas(16) inline constexpr uint8_t EncodeShuffle[2][4][16] = {
+    {
+        {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0x80, 0x00, 0x80, 0x01, 0x00},
+        {0x02, 0x01, 0x02, 0x01, 0x03, 0x02, 0x03, 0x02, 0x04, 0x03, 0x05, 0x04, 0x05, 0x04, 0x06, 0x05},
+        {0x07, 0x06, 0x07, 0x06, 0x08, 0x07, 0x08, 0x07, 0x09, 0x08, 0x0A, 0x09, 0x0A, 0x09, 0x0B, 0x0A},
+        {0x0C, 0x0B, 0x0C, 0x0B, 0x0D, 0x0C, 0x0D, 0x0C, 0x0E, 0x0D, 0x0F, 0x0E, 0x0F, 0x0E, 0x80, 0x0F},
+    },
+    {
+        {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0F, 0x80, 0x0F, 0x80, 0x0E, 0x0F},
+        {0x0D, 0x0E, 0x0D, 0x0E, 0x0C, 0x0D, 0x0C, 0x0D, 0x0B, 0x0C, 0x0A, 0x0B, 0x0A, 0x0B, 0x09, 0x0A},
+        {0x08, 0x09, 0x08, 0x09, 0x07, 0x08, 0x07, 0x08, 0x06, 0x07, 0x05, 0x06, 0x05, 0x06, 0x04, 0x05},
+        {0x03, 0x04, 0x03, 0x04, 0x02, 0x03, 0x02, 0x03, 0x01, 0x02, 0x00, 0x01, 0x00, 0x01, 0x80, 0x00},
+    },
+};
+
+/**
+ * Character j sits (16 - 5 - (5j mod 8)) bits up its window, and the high half
+ * of a multiply by 2^(16 - shift) is a right shift by that amount.
+ * */
+alignas(16) inline constexpr uint16_t EncodeShift[8] = {
+    1 << 5, 1 << 10, 1 << 7, 1 << 12, 1 << 9, 1 << 6, 1 << 11, 1 << 8,
+};
+
+/**
+ * Crockford's Base32, split into the two halves pshufb can index.
+ * */
+alignas(16) inline constexpr char EncodeAlphabet[2][16] = {
+    {'0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'},
+    {'G', 'H', 'J', 'K', 'M', 'N', 'P', 'Q', 'R', 'S', 'T', 'V', 'W', 'X', 'Y', 'Z'},
+};
+
+template <bool LittleEndian>
+ULID_TARGET_SSE41 inline __m128i EncodeGroup(__m128i x, int group) {
+    const __m128i shuffle = _mm_load_si128(reinterpret_cast<const __m128i*>(EncodeShuffle[LittleEndian][group]));
+    const __m128i shift = _mm_load_si128(reinterpret_cast<const __m128i*>(EncodeShift));
+    return _mm_and_si128(_mm_mulhi_epu16(_mm_shuffle_epi8(x, shuffle), shift), _mm_set1_epi16(31));
+}
+
+ULID_TARGET_SSE41 inline __m128i EncodeAlphabetSSE41(__m128i v) {
+    const __m128i low = _mm_load_si128(reinterpret_cast<const __m128i*>(EncodeAlphabet[0]));
+    const __m128i high = _mm_load_si128(reinterpret_cast<const __m128i*>(EncodeAlphabet[1]));
+    const __m128i is_high = _mm_cmpgt_epi8(v, _mm_set1_epi8(15));
+    return _mm_blendv_epi8(_mm_shuffle_epi8(low, v), _mm_shuffle_epi8(high, v), is_high);
+}
+
+/**
+ * EncodeSSE41 writes the 26 characters for the 16 bytes at src to dst.
+ * */
+template <bool LittleEndian>
+ULID_TARGET_SSE41 inline void EncodeSSE41(const void* src, char* dst) {
+    const __m128i x = _mm_loadu_si128(static_cast<const __m128i*>(src));
+
+    // characters 0-15 and 16-31 of the zero extended value
+    __m128i lo = _mm_packus_epi16(EncodeGroup<LittleEndian>(x, 0), EncodeGroup<LittleEndian>(x, 1));
+    __m128i hi = _mm_packus_epi16(EncodeGroup<LittleEndian>(x, 2), EncodeGroup<LittleEndian>(x, 3));
+    lo = EncodeAlphabetSSE41(lo);
+    hi = EncodeAlphabetSSE41(hi);
+
+    // the first 6 characters are the zero extension, two overlapping stores write exactly 26 bytes
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm_alignr_epi8(hi, lo, 6));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 10), hi);
+}
+
+template <bool LittleEndian>
+ULID_TARGET_AVX2 inline __m256i EncodeGroupAVX2(__m256i x, int group) {
+    const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(EncodeShuffle[LittleEndian][group])));
+    const __m256i shift = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(EncodeShift)));
+    return _mm256_and_si256(_mm256_mulhi_epu16(_mm256_shuffle_epi8(x, shuffle), shift), _mm256_set1_epi16(31));
+}
+
+ULID_TARGET_AVX2 inline __m256i EncodeAlphabetAVX2(__m256i v) {
+    const __m256i low = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(EncodeAlphabet[0])));
+    const __m256i high = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(EncodeAlphabet[1])));
+    const __m256i is_high = _mm256_cmpgt_epi8(v, _mm256_set1_epi8(15));
+    return _mm256_blendv_epi8(_mm256_shuffle_epi8(low, v), _mm256_shuffle_epi8(high, v), is_high);
+}
+
+/**
+ * EncodeBatchAVX2 writes the 26 characters for each of the n consecutive 16 byte
+ * values at src, the i-th to dst + i * stride. The bytes between them are untouched.
+ *
+ * Each 128 bit lane runs the EncodeSSE41 steps for its own ULID, two ULIDs per iteration.
+ * */
+template <bool LittleEndian>
+ULID_TARGET_AVX2 inline void EncodeBatchAVX2(const void* src, size_t n, char* dst, size_t stride) {
+    const uint8_t* p = static_cast<const uint8_t*>(src);
+
+    for (; n >= 2 ; n -= 2, p += 32, dst += 2 * stride) {
+        const __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+
+        __m256i lo = _mm256_packus_epi16(EncodeGroupAVX2<LittleEndian>(x, 0), EncodeGroupAVX2<LittleEndian>(x, 1));
+        __m256i hi = _mm256_packus_epi16(EncodeGroupAVX2<LittleEndian>(x, 2), EncodeGroupAVX2<LittleEndian>(x, 3));
+        lo = EncodeAlphabetAVX2(lo);
+        hi = EncodeAlphabetAVX2(hi);
+
+        const __m256i head = _mm256_alignr_epi8(hi, lo, 6);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), _mm256_castsi256_si128(head));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 10), _mm256_castsi256_si128(hi));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + stride), _mm256_extracti128_si256(head, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + stride + 10), _mm256_extracti128_si256(hi, 1));
+    }
+
+    if (n > 0) {
+        EncodeSSE41<LittleEndian>(p, dst);
+    }
+}
+
+#endif // ULID_BASE32_SIMD
+
+/**
+ * EncodeBatch writes the 26 characters for each of the n consecutive 16 byte
+ * values at src, the i-th to dst + i * stride (back to back by default), with the
+ * widest available kernel. Returns false, without writing anything, when there is
+ * no vector kernel and the caller has to fall back to scalar code.
+ * */
+template <bool LittleEndian>
+inline bool EncodeBatch(const void* src, size_t n, char* dst, size_t stride = 26) {
+#ifdef ULID_BASE32_SIMD
+    int level = SimdLevel();
+    if (level >= LevelAVX2) {
+        EncodeBatchAVX2<LittleEndian>(src, n, dst, stride);
+        return true;
+    }
+    if (level >= LevelSSE41) {
+        const uint8_t* p = static_cast<const uint8_t*>(src);
+        for (size_t i = 0 ; i < n ; i++) {
+            EncodeSSE41<LittleEndian>(p + 16 * i, dst + stride * i);
+        }
+        return true;
+    }
+#else
+    (void)src;
+    (void)n;
+    (void)dst;
+    (void)stride;
+#endif // ULID_BASE32_SIMD
+    return false;
+}
+
+/**
+ * DecodeAlias maps characters to their 5 bit values like dec, but also accepts
+ * lowercase letters and Crockford's aliases I, L -> 1 and O -> 0. U is invalid.
+ * 0xFF indicates invalid character.
+ * */
+inline constexpr uint8_t DecodeAlias[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    /* 0     1     2     3     4     5     6     7  */
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    /* 8     9                                      */
+    0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    /*    10(A) 11(B) 12(C) 13(D) 14(E) 15(F) 16(G) */
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+    /*17(H) 1(I)18(J) 19(K) 1(L)20(M) 21(N) 0(O)    */
+    0x11, 0x01, 0x12, 0x13, 0x01, 0x14, 0x15, 0x00,
+    /*22(P)23(Q)24(R) 25(S) 26(T)       27(V) 28(W) */
+    0x16, 0x17, 0x18, 0x19, 0x1A, 0xFF, 0x1B, 0x1C,
+    /*29(X)30(Y)31(Z)                               */
+    0x1D, 0x1E, 0x1F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    /*    10(a) 11(b) 12(c) 13(d) 14(e) 15(f) 16(g) */
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+    /*17(h) 1(i)18(j) 19(k) 1(l)20(m) 21(n) 0(o)    */
+    0x11, 0x01, 0x12, 0x13, 0x01, 0x14, 0x15, 0x00,
+    /*22(p)23(q)24(r) 25(s) 26(t)       27(v) 28(w) */
+    0x16, 0x17, 0x18, 0x19, 0x1A, 0xFF, 0x1B, 0x1C,
+    /*29(x)30(y)31(z)                               */
+    0x1D, 0x1E, 0x1F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/**
+ * DecodeScalar validates the 26 characters at src and writes the 16 byte value
+ * to dst, which is left untouched unless Status::OK is returned.
+ * */
+template <bool LittleEndian>
+inline Status DecodeScalar(const char* src, void* dst) {
+    uint8_t v[26];
+    uint8_t bad = 0;
+    for (int i = 0 ; i < 26 ; i++) {
+        v[i] = DecodeAlias[static_cast<uint8_t>(src[i])];
+        bad |= v[i];
+    }
+
+    if (bad & 0xE0) {
+        return Status::InvalidCharacter;
+    }
+    if (v[0] > 7) {
+        return Status::Overflow;
+    }
+
+    uint8_t b[16];
+    b[0] = (v[0] << 5) | v[1];
+    b[1] = (v[2] << 3) | (v[3] >> 2);
+    b[2] = (v[3] << 6) | (v[4] << 1) | (v[5] >> 4);
+    b[3] = (v[5] << 4) | (v[6] >> 1);
+    b[4] = (v[6] << 7) | (v[7] << 2) | (v[8] >> 3);
+    b[5] = (v[8] << 5) | v[9];
+    b[6] = (v[10] << 3) | (v[11] >> 2);
+    b[7] = (v[11] << 6) | (v[12] << 1) | (v[13] >> 4);
+    b[8] = (v[13] << 4) | (v[14] >> 1);
+    b[9] = (v[14] << 7) | (v[15] << 2) | (v[16] >> 3);
+    b[10] = (v[16] << 5) | v[17];
+    b[11] = (v[18] << 3) | (v[19] >> 2);
+    b[12] = (v[19] << 6) | (v[20] << 1) | (v[21] >> 4);
+    b[13] = (v[21] << 4) | (v[22] >> 1);
+    b[14] = (v[22] << 7) | (v[23] << 2) | (v[24] >> 3);
+    b[15] = (v[24] << 5) | v[25];
+
+    if (LittleEndian) {
+        for (int i = 0 ; i < 8 ; i++) {
+            uint8_t t = b[i];
+            b[i] = b[15 - i];
+            b[15 - i] = t;
+        }
+    }
+
+    std::memcpy(dst, b, 16);
+    return Status::OK;
+}
+
+#ifdef ULID_BASE32_SIMD
+
+/**
+ * DecodeLetters holds the values of 'A' to 'P' and 'Q' to 'Z', aliases included.
+ * */
+alignas(16) inline constexpr uint8_t DecodeLetters[2][16] = {
+    {0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10, 0x11, 0x01, 0x12, 0x13, 0x01, 0x14, 0x15, 0x00, 0x16},
+    {0x17, 0x18, 0x19, 0x1A, 0xFF, 0x1B, 0x1C, 0x1D, 0x1E, 0x1F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF},
+};
+
+/**
+ * DecodeGather picks the 16 output bytes out of the two packed halves, see DecodePack.
+ * [0] is for big endian output, [1] for a little endian 128 bit integer.
+ * */
+alignas(16) inline constexpr uint8_t DecodeGather[2][2][16] = {
+    {
+        {0x00, 0x0C, 0x0B, 0x0A, 0x09, 0x08, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+        {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x04, 0x03, 0x02, 0x01, 0x00, 0x0C, 0x0B, 0x0A, 0x09, 0x08},
+    },
+    {
+        {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x00},
+        {0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x00, 0x01, 0x02, 0x03, 0x04, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+    },
+};
+
+/**
+ * DecodeValuesSSE41 maps 16 characters to their 5 bit values, 0xFF for invalid characters.
+ * */
+ULID_TARGET_SSE41 inline __m128i DecodeValuesSSE41(__m128i c) {
+    // fold 'a'-'z' onto 'A'-'Z', bytes >= 0x80 are negative and fail every range check
+    const __m128i is_lower = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(0x60)), _mm_cmplt_epi8(c, _mm_set1_epi8(0x7B)));
+    c = _mm_sub_epi8(c, _mm_and_si128(is_lower, _mm_set1_epi8(0x20)));
+
+    const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(0x2F)), _mm_cmplt_epi8(c, _mm_set1_epi8(0x3A)));
+    const __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(0x40)), _mm_cmplt_epi8(c, _mm_set1_epi8(0x5B)));
+
+    const __m128i index = _mm_sub_epi8(c, _mm_set1_epi8(0x41));
+    const __m128i letters_lo = _mm_load_si128(reinterpret_cast<const __m128i*>(DecodeLetters[0]));
+    const __m128i letters_hi = _mm_load_si128(reinterpret_cast<const __m128i*>(DecodeLetters[1]));
+    const __m128i alpha = _mm_blendv_epi8(_mm_shuffle_epi8(letters_lo, index), _mm_shuffle_epi8(letters_hi, index), _mm_cmpgt_epi8(index, _mm_set1_epi8(15)));
+
+    const __m128i v = _mm_blendv_epi8(_mm_set1_epi8(-1), alpha, is_alpha);
+    return _mm_blendv_epi8(v, _mm_sub_epi8(c, _mm_set1_epi8(0x30)), is_digit);
+}
+
+/**
+ * DecodePack packs 16 five bit values into two 40 bit integers, one per 64 bit lane.
+ * */
+ULID_TARGET_SSE41 inline __m128i DecodePackSSE41(__m128i v) {
+    // 2 x 5 -> 10 bits per 16 bit lane, then 2 x 10 -> 20 bits per 32 bit lane
+    const __m128i x = _mm_madd_epi16(_mm_maddubs_epi16(v, _mm_set1_epi16(0x0120)), _mm_set1_epi32(0x00010400));
+    // 2 x 20 -> 40 bits per 64 bit lane
+    return _mm_or_si128(_mm_and_si128(_mm_slli_epi64(x, 20), _mm_set1_epi64x(0xFFFFF00000ll)), _mm_srli_epi64(x, 32));
+}
+
+/**
+ * DecodeSSE41 is DecodeScalar with vector instructions.
+ *
+ * Two overlapping loads read characters 0-15 and 10-25. The first is shifted up
+ * 6 lanes to zero extend the value to 32 characters (160 bits), packed into four
+ * 40 bit groups and the low 16 bytes are gathered with pshufb.
+ * */
+template <bool LittleEndian>
+ULID_TARGET_SSE41 inline Status DecodeSSE41(const char* src, void* dst) {
+    const __m128i a = DecodeValuesSSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+    const __m128i b = DecodeValuesSSE41(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 10)));
+
+    if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0) {
+        return Status::InvalidCharacter;
+    }
+    if ((_mm_cvtsi128_si32(a) & 0xFF) > 7) {
+        return Status::Overflow;
+    }
+
+    const __m128i lo = DecodePackSSE41(_mm_slli_si128(a, 6));
+    const __m128i hi = DecodePackSSE41(b);
+    const __m128i out = _mm_or_si128(
+        _mm_shuffle_epi8(lo, _mm_load_si128(reinterpret_cast<const __m128i*>(DecodeGather[LittleEndian][0]))),
+        _mm_shuffle_epi8(hi, _mm_load_si128(reinterpret_cast<const __m128i*>(DecodeGather[LittleEndian][1]))));
+
+    _mm_storeu_si128(static_cast<__m128i*>(dst), out);
+    return Status::OK;
+}
+
+ULID_TARGET_AVX2 inline __m256i DecodeValuesAVX2(__m256i c) {
+    const __m256i is_lower = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(0x60)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x7B), c));
+    c = _mm256_sub_epi8(c, _mm256_and_si256(is_lower, _mm256_set1_epi8(0x20)));
+
+    const __m256i is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(0x2F)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x3A), c));
+    const __m256i is_alpha = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8(0x40)), _mm256_cmpgt_epi8(_mm256_set1_epi8(0x5B), c));
+
+    const __m256i index = _mm256_sub_epi8(c, _mm256_set1_epi8(0x41));
+    const __m256i letters_lo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(DecodeLetters[0])));
+    const __m256i letters_hi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(DecodeLetters[1])));
+    const __m256i alpha = _mm256_blendv_epi8(_mm256_shuffle_epi8(letters_lo, index), _mm256_shuffle_epi8(letters_hi, index), _mm256_cmpgt_epi8(index, _mm256_set1_epi8(15)));
+
+    const __m256i v = _mm256_blendv_epi8(_mm256_set1_epi8(-1), alpha, is_alpha);
+    return _mm256_blendv_epi8(v, _mm256_sub_epi8(c, _mm256_set1_epi8(0x30)), is_digit);
+}
+
+ULID_TARGET_AVX2 inline __m256i DecodePackAVX2(__m256i v) {
+    const __m256i x = _mm256_madd_epi16(_mm256_maddubs_epi16(v, _mm256_set1_epi16(0x0120)), _mm256_set1_epi32(0x00010400));
+    return _mm256_or_si256(_mm256_and_si256(_mm256_slli_epi64(x, 20), _mm256_set1_epi64x(0xFFFFF00000ll)), _mm256_srli_epi64(x, 32));
+}
+
+/**
+ * DecodeBatchAVX2 decodes n strings, the i-th at src + i * stride, into n consecutive
+ * 16 byte values at dst, two per iteration with one string per 128 bit lane.
+ *
+ * Returns the number of values written, less than n when the string at that
+ * index does not validate.
+ * */
+template <bool LittleEndian>
+ULID_TARGET_AVX2 inline size_t DecodeBatchAVX2(const char* src, size_t n, size_t stride, void* dst) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    const __m256i gather_lo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(DecodeGather[LittleEndian][0])));
+    const __m256i gather_hi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(DecodeGather[LittleEndian][1])));
+
+    size_t i = 0;
+    for (; i + 2 <= n ; i += 2) {
+        const char* s0 = src + i * stride;
+        const char* s1 = s0 + stride;
+
+        const __m256i a = DecodeValuesAVX2(_mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1)), 1));
+        const __m256i b = DecodeValuesAVX2(_mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s0 + 10))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(s1 + 10)), 1));
+
+        // any invalid character or a first character above 7 in either lane
+        const __m256i first = _mm256_and_si256(a, _mm256_setr_epi64x(0xFF, 0, 0xFF, 0));
+        const __m256i overflow = _mm256_cmpgt_epi8(first, _mm256_set1_epi8(7));
+        if (_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(a, b), overflow)) != 0) {
+            break;
+        }
+
+        const __m256i lo = DecodePackAVX2(_mm256_slli_si256(a, 6));
+        const __m256i hi = DecodePackAVX2(b);
+        const __m256i x = _mm256_or_si256(_mm256_shuffle_epi8(lo, gather_lo), _mm256_shuffle_epi8(hi, gather_hi));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 16 * i), x);
+    }
+
+    // the remainder, or the pair holding the first invalid string
+    for (; i < n ; i++) {
+        if (DecodeSSE41<LittleEndian>(src + i * stride, out + 16 * i) != Status::OK) {
+            break;
+        }
+    }
+    return i;
+}
+
+#endif // ULID_BASE32_SIMD
+
+/**
+ * Decode validates and decodes the 26 characters at src into the 16 bytes at dst
+ * with the widest available kernel.
+ * */
+template <bool LittleEndian>
+inline Status Decode(const char* src, void* dst) {
+#ifdef ULID_BASE32_SIMD
+    if (SimdLevel() >= LevelSSE41) {
+        return DecodeSSE41<LittleEndian>(src, dst);
+    }
+#endif // ULID_BASE32_SIMD
+    return DecodeScalar<LittleEndian>(src, dst);
+}
+
+/**
+ * DecodeBatch decodes n strings, the i-th at src + i * stride, into n consecutive
+ * 16 byte values at dst. Returns the number of values written, less than n when
+ * the string at that index does not validate.
+ * */
+template <bool LittleEndian>
+inline size_t DecodeBatch(const char* src, size_t n, size_t stride, void* dst) {
+#ifdef ULID_BASE32_SIMD
+    if (SimdLevel() >= LevelAVX2) {
+        return DecodeBatchAVX2<LittleEndian>(src, n, stride, dst);
+    }
+#endif // ULID_BASE32_SIMD
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    size_t i = 0;
+    for (; i < n ; i++) {
+        if (Decode<LittleEndian>(src + i * stride, out + 16 * i) != Status::OK) {
+            break;
+        }
+    }
+    return i;
+}
+
+/**
+ * DecodeLines decodes up to n newline terminated strings from [src, src + len)
+ * into consecutive 16 byte values at dst. Every line must be exactly 26 characters,
+ * optionally followed by '\r', and the last line may end without a newline.
+ *
+ * Returns the number of values written and sets *consumed to the number of bytes
+ * read, so src + *consumed is the first line that was not decoded.
+ * */
+template <bool LittleEndian>
+inline size_t DecodeLines(const char* src, size_t len, size_t n, void* dst, size_t* consumed) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    size_t pos = 0;
+    size_t i = 0;
+
+    // runs of plain "\n" lines share a stride of 27 and go through the batch kernel
+    while (i < n && pos < len) {
+        size_t run = 0;
+        while (i + run < n && pos + 27 * (run + 1) <= len && src[pos + 27 * run + 26] == '\n') {
+            run++;
+        }
+
+        if (run > 0) {
+            size_t done = DecodeBatch<LittleEndian>(src + pos, run, 27, out + 16 * i);
+            i += done;
+            pos += 27 * done;
+            if (done < run) {
+                break;
+            }
+            continue;
+        }
+
+        // a single line ending in "\r\n" or at the end of the input
+        size_t end = pos + 26;
+        if (end > len) {
+            break;
+        }
+        size_t next = end;
+        if (next < len && src[next] == '\r') {
+            next++;
+        }
+        if (next < len) {
+            if (src[next] != '\n') {
+                break;
+            }
+            next++;
+        }
+        if (Decode<LittleEndian>(src + pos, out + 16 * i) != Status::OK) {
+            break;
+        }
+        i++;
+        pos = next;
+    }
+
+    if (consumed != nullptr) {
+        *consumed = pos;
+    }
+    return i;
+}
+
+};  // namespace base32
+};  // namespace ulid
+
+#endif // ULID_BASE32_HH
@@ -1,11 +1,69 @@
 #include <benchmark/benchmark.h>
 
-#ifdef ULIDUINT128
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <streambuf>
+#include <unordered_set>
+
+#if defined(ULID_WITH_EXECUTION)
+#include <execution>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(ULIDUINT128)
 #include "ulid_uint128.hh"
+#elif defined(ULIDU64PAIR)
+#include "ulid_u64pair.hh"
 #else
 #include "ulid_struct.hh"
 #endif // ULIDUINT128
 
+// every heap allocation in the process is counted, so benchmarks can report
+// allocations per iteration with ReportAllocations.
+static std::atomic<size_t> allocations(0);
+
+// the replacements are kept out of line, g++ otherwise inlines them into
+// their callers and warns about the malloc'd pointers reaching free through
+// operator delete.
+#if defined(_MSC_VER)
+#define ULID_BENCH_NOINLINE __declspec(noinline)
+#else
+#define ULID_BENCH_NOINLINE __attribute__((noinline))
+#endif
+
+ULID_BENCH_NOINLINE void* operator new(size_t n) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	void* p = std::malloc(n == 0 ? 1 : n);
+	if (p == nullptr) {
+		throw std::bad_alloc();
+	}
+	return p;
+}
+
+ULID_BENCH_NOINLINE void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+ULID_BENCH_NOINLINE void operator delete(void* p, size_t) noexcept {
+	std::free(p);
+}
+
+static void ReportAllocations(benchmark::State& state, size_t before) {
+	size_t count = allocations.load(std::memory_order_relaxed) - before;
+	state.counters["allocs/op"] = benchmark::Counter(
+		static_cast<double>(count) / static_cast<double>(state.iterations()));
+}
+
 static void EncodeTime(benchmark::State& state) {
 	ulid::ULID ulid;
 	while (state.KeepRunning()) {
@@ -33,10 +91,24 @@ static void EncodeTimeSystemClockNow(benchmark::State& state) {
 
 BENCHMARK(EncodeTimeSystemClockNow);
 
+template <class Clock>
+static void ClockNow(benchmark::State& state) {
+	Clock clock;
+	while (state.KeepRunning()) {
+		benchmark::DoNotOptimize(clock.Now());
+	}
+}
+
+BENCHMARK_TEMPLATE(ClockNow, ulid::clocks::SystemClock);
+BENCHMARK_TEMPLATE(ClockNow, ulid::clocks::RealtimeClock);
+BENCHMARK_TEMPLATE(ClockNow, ulid::clocks::CoarseClock);
+BENCHMARK_TEMPLATE(ClockNow, ulid::clocks::TscClock<>);
+
 static void EncodeEntropy(benchmark::State& state) {
 	ulid::ULID ulid;
 	while (state.KeepRunning()) {
 		ulid::EncodeEntropy([]() { return 4; }, ulid);
+		benchmark::DoNotOptimize(ulid);
 	}
 }
 
@@ -62,15 +134,79 @@ static void EncodeEntropyMt19937(benchmark::State& state) {
 
 BENCHMARK(EncodeEntropyMt19937);
 
+static void EncodeEntropyMt19937Default(benchmark::State& state) {
+	ulid::ULID ulid;
+	while (state.KeepRunning()) {
+		ulid::EncodeEntropyMt19937(ulid);
+	}
+}
+
+BENCHMARK(EncodeEntropyMt19937Default);
+
+static void EncodeEntropySecure(benchmark::State& state) {
+	ulid::ULID ulid;
+	while (state.KeepRunning()) {
+		ulid::EncodeEntropySecure(ulid);
+		benchmark::DoNotOptimize(ulid);
+	}
+}
+
+BENCHMARK(EncodeEntropySecure);
+
 static void Encode(benchmark::State& state) {
 	ulid::ULID ulid;
 	while (state.KeepRunning()) {
 		ulid::Encode(1484581420, []() { return 4; }, ulid);
+		benchmark::DoNotOptimize(ulid);
 	}
 }
 
 BENCHMARK(Encode);
 
+static void EncodeFunction(benchmark::State& state) {
+	ulid::ULID ulid;
+	std::function<uint8_t()> rng = []() { return 4; };
+	while (state.KeepRunning()) {
+		ulid::Encode(1484581420, rng, ulid);
+		benchmark::DoNotOptimize(ulid);
+	}
+}
+
+BENCHMARK(EncodeFunction);
+
+static void EncodeMt19937_64(benchmark::State& state) {
+	ulid::ULID ulid;
+	std::mt19937_64 gen(4);
+	while (state.KeepRunning()) {
+		ulid::Encode(1484581420, gen, ulid);
+		benchmark::DoNotOptimize(ulid);
+	}
+}
+
+BENCHMARK(EncodeMt19937_64);
+
+struct FillRng {
+	std::mt19937_64 gen{4};
+
+	void fill(uint8_t* dst, size_t n) {
+		for (size_t i = 0 ; i < n ; i += 8) {
+			uint64_t w = gen();
+			std::memcpy(dst + i, &w, n - i < 8 ? n - i : 8);
+		}
+	}
+};
+
+static void EncodeFill(benchmark::State& state) {
+	ulid::ULID ulid;
+	FillRng rng;
+	while (state.KeepRunning()) {
+		ulid::Encode(1484581420, rng, ulid);
+		benchmark::DoNotOptimize(ulid);
+	}
+}
+
+BENCHMARK(EncodeFill);
+
 static void EncodeNowRand(benchmark::State& state) {
 	ulid::ULID ulid;
 	while (state.KeepRunning()) {
@@ -83,38 +219,304 @@ BENCHMARK(EncodeNowRand);
 static void Create(benchmark::State& state) {
 	while (state.KeepRunning()) {
 		ulid::ULID ulid = ulid::Create(1484581420, []() { return 4; });
+		benchmark::DoNotOptimize(ulid);
 	}
 }
 
 BENCHMARK(Create);
 
+static void CreateFunction(benchmark::State& state) {
+	std::function<uint8_t()> rng = []() { return 4; };
+	while (state.KeepRunning()) {
+		ulid::ULID ulid = ulid::Create(1484581420, rng);
+		benchmark::DoNotOptimize(ulid);
+	}
+}
+
+BENCHMARK(CreateFunction);
+
+static void CreateMt19937_64(benchmark::State& state) {
+	std::mt19937_64 gen(4);
+	while (state.KeepRunning()) {
+		ulid::ULID ulid = ulid::Create(1484581420, gen);
+		benchmark::DoNotOptimize(ulid);
+	}
+}
+
+BENCHMARK(CreateMt19937_64);
+
 static void CreateNowRand(benchmark::State& state) {
 	while (state.KeepRunning()) {
 		ulid::ULID ulid = ulid::CreateNowRand();
+		benchmark::DoNotOptimize(ulid);
 	}
 }
 
 BENCHMARK(CreateNowRand);
 
+static void GenerateBatch(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids(state.range(0));
+	while (state.KeepRunning()) {
+		ulid::GenerateBatch(ulids.data(), ulids.size());
+		benchmark::DoNotOptimize(ulids.data());
+	}
+	state.counters["time/ID"] = benchmark::Counter(
+		state.iterations() * ulids.size(),
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(GenerateBatch)->Arg(1 << 10)->Arg(1 << 16);
+
+static void GenerateBatchSecure(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids(state.range(0));
+	while (state.KeepRunning()) {
+		ulid::GenerateBatch(ulid::entropy::SecureRandom(), ulids.data(), ulids.size());
+		benchmark::DoNotOptimize(ulids.data());
+	}
+	state.counters["time/ID"] = benchmark::Counter(
+		state.iterations() * ulids.size(),
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(GenerateBatchSecure)->Arg(1 << 10)->Arg(1 << 16);
+
+static void CounterGeneratorFill(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids(state.range(0));
+	ulid::CounterGenerator gen(42, 0, 1484581420, 1000);
+	while (state.KeepRunning()) {
+		gen.Fill(ulids.data(), ulids.size());
+		benchmark::DoNotOptimize(ulids.data());
+	}
+	state.counters["time/ID"] = benchmark::Counter(
+		state.iterations() * ulids.size(),
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(CounterGeneratorFill)->Arg(1 << 10)->Arg(1 << 16);
+
+static void CounterGeneratorNext(benchmark::State& state) {
+	ulid::CounterGenerator gen(42, 0, 1484581420, 1000);
+	ulid::ULID ulid;
+	while (state.KeepRunning()) {
+		gen.Next(ulid);
+		benchmark::DoNotOptimize(ulid);
+	}
+}
+
+BENCHMARK(CounterGeneratorNext);
+
+static void GenerateNow(benchmark::State& state) {
+	ulid::ULID ulid;
+	while (state.KeepRunning()) {
+		ulid::GenerateNow(ulid);
+	}
+}
+
+BENCHMARK(GenerateNow);
+
+static void MonotonicGenerator(benchmark::State& state) {
+	static ulid::MonotonicGenerator gen;
+	ulid::ULID ulid;
+	while (state.KeepRunning()) {
+		gen.Next(ulid);
+	}
+}
+
+BENCHMARK(MonotonicGenerator)->ThreadRange(1, 8);
+
+static void PartitionedGenerator(benchmark::State& state) {
+	static ulid::PartitionedGenerator gen(ulid::EntropyLayout{16, 16}, 42);
+	ulid::ULID ulid;
+	while (state.KeepRunning()) {
+		gen.Next(ulid);
+	}
+}
+
+BENCHMARK(PartitionedGenerator)->ThreadRange(1, 8);
+
+// Latencies times every call of fn on its own and reports percentiles of the
+// distribution in ns, averaged over the threads, where time/ID would hide the
+// tail behind the mean. Each measurement includes two steady_clock reads.
+template <class Fn>
+static void Latencies(benchmark::State& state, Fn fn) {
+	std::vector<int64_t> ns;
+	ns.reserve(1 << 20);
+	while (state.KeepRunning()) {
+		auto start = std::chrono::steady_clock::now();
+		fn();
+		auto end = std::chrono::steady_clock::now();
+		ns.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+	}
+	if (ns.empty()) {
+		return;
+	}
+
+	std::sort(ns.begin(), ns.end());
+	auto percentile = [&ns](double p) { return static_cast<double>(ns[static_cast<size_t>(p * (ns.size() - 1))]); };
+	state.counters["p50"] = benchmark::Counter(percentile(0.5), benchmark::Counter::kAvgThreads);
+	state.counters["p99"] = benchmark::Counter(percentile(0.99), benchmark::Counter::kAvgThreads);
+	state.counters["p99.9"] = benchmark::Counter(percentile(0.999), benchmark::Counter::kAvgThreads);
+	state.counters["max"] = benchmark::Counter(percentile(1), benchmark::Counter::kAvgThreads);
+}
+
+static void CreateNowRandLatency(benchmark::State& state) {
+	Latencies(state, [] { benchmark::DoNotOptimize(ulid::CreateNowRand()); });
+}
+
+BENCHMARK(CreateNowRandLatency)->ThreadRange(1, 64)->UseRealTime();
+
+static void IdDispenserLatency(benchmark::State& state) {
+	static ulid::IdDispenser dispenser;
+	Latencies(state, [] { benchmark::DoNotOptimize(dispenser.Next()); });
+}
+
+BENCHMARK(IdDispenserLatency)->ThreadRange(1, 64)->UseRealTime();
+
 static void MarshalTo(benchmark::State& state) {
 	char a[27];
 	ulid::ULID ulid = ulid::CreateNowRand();
 	while (state.KeepRunning()) {
 		ulid::MarshalTo(ulid, a);
+		benchmark::DoNotOptimize(a);
 	}
 }
 
 BENCHMARK(MarshalTo);
 
+static void MarshalToScalar(benchmark::State& state) {
+	char a[27];
+	ulid::ULID ulid = ulid::CreateNowRand();
+	while (state.KeepRunning()) {
+		ulid::MarshalToScalar(ulid, a);
+		benchmark::DoNotOptimize(a);
+	}
+}
+
+BENCHMARK(MarshalToScalar);
+
+static void MarshalToHuman(benchmark::State& state) {
+	char a[36];
+	ulid::ULID ulid = ulid::CreateNowRand();
+	while (state.KeepRunning()) {
+		ulid::MarshalToHuman(ulid, a);
+		benchmark::DoNotOptimize(a);
+	}
+}
+
+BENCHMARK(MarshalToHuman);
+
+static void MarshalToHumanRandom(benchmark::State& state) {
+	// timestamps spread over decades, so the date is converted every time
+	std::vector<ulid::ULID> ulids(1024);
+	std::mt19937_64 generator(4);
+	for (auto& ulid : ulids) {
+		ulid = ulid::Create(generator() % 4102444800000, generator);
+	}
+
+	char a[36];
+	size_t i = 0;
+	while (state.KeepRunning()) {
+		ulid::MarshalToHuman(ulids[i++ & 1023], a);
+		benchmark::DoNotOptimize(a);
+	}
+}
+
+BENCHMARK(MarshalToHumanRandom);
+
+static void UnmarshalHumanFrom(benchmark::State& state) {
+	ulid::ULID ulid;
+	while (state.KeepRunning()) {
+		ulid::UnmarshalHumanFrom("20160730T223616385Z0G2081040G208104", ulid);
+		benchmark::DoNotOptimize(ulid);
+	}
+}
+
+BENCHMARK(UnmarshalHumanFrom);
+
+static void MarshalBatch(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids(state.range(0));
+	ulid::GenerateBatch(ulids.data(), ulids.size());
+	std::vector<char> dst(26 * ulids.size());
+	while (state.KeepRunning()) {
+		ulid::MarshalBatch(ulids.data(), ulids.size(), dst.data());
+		benchmark::DoNotOptimize(dst.data());
+	}
+	state.SetItemsProcessed(state.iterations() * ulids.size());
+	state.SetBytesProcessed(state.iterations() * dst.size());
+}
+
+BENCHMARK(MarshalBatch)->Arg(1 << 10)->Arg(1 << 16);
+
 static void Marshal(benchmark::State& state) {
 	ulid::ULID ulid = ulid::CreateNowRand();
+	size_t before = allocations.load();
 	while (state.KeepRunning()) {
 		std::string m = ulid::Marshal(ulid);
 	}
+	ReportAllocations(state, before);
 }
 
 BENCHMARK(Marshal);
 
+static void MarshalArray(benchmark::State& state) {
+	ulid::ULID ulid = ulid::CreateNowRand();
+	size_t before = allocations.load();
+	while (state.KeepRunning()) {
+		std::array<char, 26> m = ulid::MarshalArray(ulid);
+		benchmark::DoNotOptimize(m);
+	}
+	ReportAllocations(state, before);
+}
+
+BENCHMARK(MarshalArray);
+
+// FixedBuf is a stream buffer over a fixed array, rewound every iteration.
+class FixedBuf : public std::streambuf {
+public:
+	void rewind() {
+		setp(buffer, buffer + sizeof(buffer));
+	}
+
+private:
+	char buffer[64];
+};
+
+static void MarshalOstream(benchmark::State& state) {
+	ulid::ULID ulid = ulid::CreateNowRand();
+	FixedBuf buf;
+	std::ostream os(&buf);
+	using ulid::operator<<;
+
+	size_t before = allocations.load();
+	while (state.KeepRunning()) {
+		buf.rewind();
+		os << ulid;
+	}
+	ReportAllocations(state, before);
+}
+
+BENCHMARK(MarshalOstream);
+
+#if !defined(ULIDUINT128) && (defined(__cpp_lib_format) || defined(ULID_WITH_FMT))
+static void MarshalFormat(benchmark::State& state) {
+	ulid::ULID ulid = ulid::CreateNowRand();
+	char buffer[64];
+
+	size_t before = allocations.load();
+	while (state.KeepRunning()) {
+#if defined(__cpp_lib_format)
+		char* end = std::format_to(buffer, "id={}", ulid);
+#else
+		char* end = fmt::format_to(buffer, "id={}", ulid);
+#endif
+		benchmark::DoNotOptimize(end);
+	}
+	ReportAllocations(state, before);
+}
+
+BENCHMARK(MarshalFormat);
+#endif
+
 static void MarshalBinaryTo(benchmark::State& state) {
 	uint8_t a[16];
 	ulid::ULID ulid = ulid::CreateNowRand();
@@ -127,30 +529,77 @@ BENCHMARK(MarshalBinaryTo);
 
 static void MarshalBinary(benchmark::State& state) {
 	ulid::ULID ulid = ulid::CreateNowRand();
+	size_t before = allocations.load();
 	while (state.KeepRunning()) {
 		std::vector<uint8_t> m = ulid::MarshalBinary(ulid);
 	}
+	ReportAllocations(state, before);
 }
 
 BENCHMARK(MarshalBinary);
 
+static void MarshalBinaryArray(benchmark::State& state) {
+	ulid::ULID ulid = ulid::CreateNowRand();
+	size_t before = allocations.load();
+	while (state.KeepRunning()) {
+		std::array<uint8_t, 16> m = ulid::MarshalBinaryArray(ulid);
+		benchmark::DoNotOptimize(m);
+	}
+	ReportAllocations(state, before);
+}
+
+BENCHMARK(MarshalBinaryArray);
+
 static void UnmarshalFrom(benchmark::State& state) {
 	ulid::ULID ulid;
 	while (state.KeepRunning()) {
 		ulid::UnmarshalFrom("0001C7STHC0G2081040G208104", ulid);
+		benchmark::DoNotOptimize(ulid);
 	}
 }
 
 BENCHMARK(UnmarshalFrom);
 
 static void Unmarshal(benchmark::State& state) {
+	size_t before = allocations.load();
 	while (state.KeepRunning()) {
 		ulid::ULID ulid = ulid::Unmarshal("0001C7STHC0G2081040G208104");
+		benchmark::DoNotOptimize(ulid);
 	}
+	ReportAllocations(state, before);
 }
 
 BENCHMARK(Unmarshal);
 
+static void TryUnmarshalFrom(benchmark::State& state) {
+	ulid::ULID ulid;
+	while (state.KeepRunning()) {
+		ulid::Status status = ulid::TryUnmarshalFrom("0001C7STHC0G2081040G208104", ulid);
+		benchmark::DoNotOptimize(status);
+		benchmark::DoNotOptimize(ulid);
+	}
+}
+
+BENCHMARK(TryUnmarshalFrom);
+
+static void TryUnmarshalBatch(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids(state.range(0));
+	ulid::GenerateBatch(ulids.data(), ulids.size());
+	std::string src(27 * ulids.size(), '\n');
+	for (size_t i = 0 ; i < ulids.size() ; i++) {
+		ulid::MarshalTo(ulids[i], &src[27 * i]);
+	}
+
+	while (state.KeepRunning()) {
+		size_t n = ulid::TryUnmarshalBatch(src.data(), ulids.size(), 27, ulids.data());
+		benchmark::DoNotOptimize(n);
+	}
+	state.SetItemsProcessed(state.iterations() * ulids.size());
+	state.SetBytesProcessed(state.iterations() * src.size());
+}
+
+BENCHMARK(TryUnmarshalBatch)->Arg(1 << 10)->Arg(1 << 16);
+
 static void UnmarshalBinaryFrom(benchmark::State& state) {
 	ulid::ULID ulid;
 	uint8_t b[16] = {0x1, 0xc0, 0x73, 0x62, 0x4a, 0xaf, 0x39, 0x78, 0x51, 0x4e, 0xf8, 0x44, 0x3b, 0xb2, 0xa8, 0x59};
@@ -162,17 +611,32 @@ static void UnmarshalBinaryFrom(benchmark::State& state) {
 BENCHMARK(UnmarshalBinaryFrom);
 
 static void UnmarshalBinary(benchmark::State& state) {
+	size_t before = allocations.load();
 	while (state.KeepRunning()) {
 		ulid::ULID ulid = ulid::UnmarshalBinary({0x1, 0xc0, 0x73, 0x62, 0x4a, 0xaf, 0x39, 0x78, 0x51, 0x4e, 0xf8, 0x44, 0x3b, 0xb2, 0xa8, 0x59});
+		benchmark::DoNotOptimize(ulid);
 	}
+	ReportAllocations(state, before);
 }
 
 BENCHMARK(UnmarshalBinary);
 
+static void UnmarshalBinaryVector(benchmark::State& state) {
+	size_t before = allocations.load();
+	while (state.KeepRunning()) {
+		ulid::ULID ulid = ulid::UnmarshalBinary(std::vector<uint8_t>{0x1, 0xc0, 0x73, 0x62, 0x4a, 0xaf, 0x39, 0x78, 0x51, 0x4e, 0xf8, 0x44, 0x3b, 0xb2, 0xa8, 0x59});
+		benchmark::DoNotOptimize(ulid);
+	}
+	ReportAllocations(state, before);
+}
+
+BENCHMARK(UnmarshalBinaryVector);
+
 static void Time(benchmark::State& state) {
 	ulid::ULID ulid = ulid::CreateNowRand();
 	while (state.KeepRunning()) {
 		time_t t = ulid::Time(ulid);
+		benchmark::DoNotOptimize(t);
 	}
 }
 
@@ -183,9 +647,569 @@ static void CompareULIDs(benchmark::State& state) {
 	ulid::ULID ulid2 = ulid1;
 	while (state.KeepRunning()) {
 		int res = ulid::CompareULIDs(ulid1, ulid2);
+		benchmark::DoNotOptimize(res);
 	}
 }
 
 BENCHMARK(CompareULIDs);
 
+static void CompareULIDsRandom(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids(1024);
+	ulid::GenerateBatch(ulids.data(), ulids.size());
+
+	size_t i = 0;
+	while (state.KeepRunning()) {
+		int res = ulid::CompareULIDs(ulids[i], ulids[(i + 1) & 1023]);
+		benchmark::DoNotOptimize(res);
+		i = (i + 1) & 1023;
+	}
+}
+
+BENCHMARK(CompareULIDsRandom);
+
+// SortInput is n ULIDs spread over one day, in random order.
+static std::vector<ulid::ULID> SortInput(size_t n) {
+	std::vector<ulid::ULID> ulids(n);
+	ulid::GenerateBatch(ulids.data(), ulids.size());
+	std::mt19937& generator = ulid::DefaultGenerator();
+	for (auto& ulid : ulids) {
+		ulid::EncodeTime(1484581420000 + generator() % 86400000, ulid);
+	}
+	return ulids;
+}
+
+static void SortULIDs(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids = SortInput(state.range(0));
+
+	std::vector<ulid::ULID> scratch;
+	while (state.KeepRunning()) {
+		scratch = ulids;
+		std::sort(scratch.begin(), scratch.end());
+		benchmark::DoNotOptimize(scratch.data());
+	}
+	state.counters["time/ID"] = benchmark::Counter(
+		state.iterations() * ulids.size(),
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(SortULIDs)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+#if defined(ULID_WITH_EXECUTION)
+static void SortULIDsParallel(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids = SortInput(state.range(0));
+
+	std::vector<ulid::ULID> scratch;
+	while (state.KeepRunning()) {
+		scratch = ulids;
+		std::sort(std::execution::par, scratch.begin(), scratch.end());
+		benchmark::DoNotOptimize(scratch.data());
+	}
+	state.counters["time/ID"] = benchmark::Counter(
+		state.iterations() * ulids.size(),
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(SortULIDsParallel)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond)->UseRealTime();
+#endif
+
+// the second argument is the number of threads, 0 for all of them
+static void RadixSortULIDs(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids = SortInput(state.range(0));
+
+	std::vector<ulid::ULID> scratch;
+	while (state.KeepRunning()) {
+		scratch = ulids;
+		ulid::Sort(scratch.data(), scratch.size(), static_cast<unsigned>(state.range(1)));
+		benchmark::DoNotOptimize(scratch.data());
+	}
+	state.counters["time/ID"] = benchmark::Counter(
+		state.iterations() * ulids.size(),
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK(RadixSortULIDs)->Apply([](benchmark::internal::Benchmark* b) {
+	for (int n : {1000000, 10000000, 100000000}) {
+		b->Args({n, 1});
+		b->Args({n, 0});
+	}
+})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// IndexInput is SortInput, sorted, and random ULIDs from the same day to look up.
+static std::pair<std::vector<ulid::ULID>, std::vector<ulid::ULID>> IndexInput(size_t n) {
+	std::vector<ulid::ULID> ulids = SortInput(n);
+	ulid::Sort(ulids.data(), ulids.size());
+	return std::make_pair(std::move(ulids), SortInput(1 << 16));
+}
+
+static void LowerBound(benchmark::State& state) {
+	auto input = IndexInput(state.range(0));
+	const std::vector<ulid::ULID>& ulids = input.first;
+	const std::vector<ulid::ULID>& queries = input.second;
+
+	size_t i = 0;
+	while (state.KeepRunning()) {
+		const ulid::ULID& q = queries[i++ & (queries.size() - 1)];
+		benchmark::DoNotOptimize(std::lower_bound(ulids.begin(), ulids.end(), q));
+	}
+}
+
+BENCHMARK(LowerBound)->Arg(1000000)->Arg(10000000)->Arg(100000000);
+
+static void IndexLowerBound(benchmark::State& state) {
+	auto input = IndexInput(state.range(0));
+	const std::vector<ulid::ULID>& queries = input.second;
+	ulid::UlidIndex index(input.first.data(), input.first.size());
+
+	size_t i = 0;
+	while (state.KeepRunning()) {
+		benchmark::DoNotOptimize(index.LowerBound(queries[i++ & (queries.size() - 1)]));
+	}
+}
+
+BENCHMARK(IndexLowerBound)->Arg(1000000)->Arg(10000000)->Arg(100000000);
+
+// one minute of ULIDs
+static void IndexTimeRange(benchmark::State& state) {
+	auto input = IndexInput(state.range(0));
+	const std::vector<ulid::ULID>& queries = input.second;
+	ulid::UlidIndex index(input.first.data(), input.first.size());
+
+	size_t i = 0;
+	while (state.KeepRunning()) {
+		time_t from = ulid::Time(queries[i++ & (queries.size() - 1)]);
+		benchmark::DoNotOptimize(index.TimeRange(from, from + 59999));
+	}
+}
+
+BENCHMARK(IndexTimeRange)->Arg(1000000)->Arg(10000000)->Arg(100000000);
+
+#ifdef ULID_HAS_MMAP
+// BinaryFile is a temporary file of n sorted ULIDs written with MarshalBinaryTo,
+// written once and shared by the file benchmarks. The page cache is warm.
+struct BinaryFile {
+	std::string path;
+	size_t n = 0;
+
+	~BinaryFile() {
+		if (!path.empty()) {
+			unlink(path.c_str());
+		}
+	}
+
+	static const BinaryFile& Get(size_t n) {
+		static BinaryFile file;
+		if (file.n != n) {
+			if (!file.path.empty()) {
+				unlink(file.path.c_str());
+			}
+			char path[] = "/tmp/ulid_bench_XXXXXX";
+			int fd = mkstemp(path);
+			file.path = path;
+			file.n = n;
+
+			// consecutive milliseconds, already sorted
+			std::vector<uint8_t> chunk(16 << 16);
+			for (size_t i = 0 ; i < n ; i += 1 << 16) {
+				size_t m = std::min<size_t>(n - i, 1 << 16);
+				for (size_t j = 0 ; j < m ; j++) {
+					ulid::ULID ulid = ulid::Create(1484581420000 + i + j, ulid::DefaultGenerator());
+					ulid::MarshalBinaryTo(ulid, chunk.data() + 16 * j);
+				}
+				if (write(fd, chunk.data(), 16 * m) != static_cast<ssize_t>(16 * m)) {
+					abort();
+				}
+			}
+			close(fd);
+		}
+		return file;
+	}
+};
+
+// time to first lookup: read the whole file and unmarshal every record
+static void FileReadFirstLookup(benchmark::State& state) {
+	const BinaryFile& file = BinaryFile::Get(state.range(0));
+	ulid::ULID q = ulid::Create(1484581420000 + file.n / 3, []() { return 4; });
+
+	std::vector<uint8_t> buffer(16 << 16);
+	while (state.KeepRunning()) {
+		std::vector<ulid::ULID> ulids(file.n);
+		int fd = open(file.path.c_str(), O_RDONLY);
+		size_t i = 0;
+		for (ssize_t r ; (r = read(fd, buffer.data(), buffer.size())) > 0 ; ) {
+			for (ssize_t j = 0 ; j < r ; j += 16) {
+				ulid::UnmarshalBinaryFrom(buffer.data() + j, ulids[i++]);
+			}
+		}
+		close(fd);
+		benchmark::DoNotOptimize(std::lower_bound(ulids.begin(), ulids.end(), q));
+	}
+}
+
+BENCHMARK(FileReadFirstLookup)->Arg(1 << 27)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// time to first lookup: map the file and search it in place
+static void FileMappedFirstLookup(benchmark::State& state) {
+	const BinaryFile& file = BinaryFile::Get(state.range(0));
+	ulid::ULID q = ulid::Create(1484581420000 + file.n / 3, []() { return 4; });
+
+	while (state.KeepRunning()) {
+		ulid::MappedUlidFile mapped;
+		mapped.Open(file.path);
+		mapped.Advise(ulid::MappedUlidFile::Random);
+		benchmark::DoNotOptimize(mapped.LowerBound(q));
+	}
+}
+
+BENCHMARK(FileMappedFirstLookup)->Arg(1 << 27)->Unit(benchmark::kMicrosecond)->UseRealTime();
+#endif
+
+// StreamInput is n lines of text ULIDs and their n binary records.
+static std::pair<std::string, std::string> StreamInput(size_t n) {
+	std::vector<ulid::ULID> ulids(n);
+	ulid::GenerateBatch(ulids.data(), n);
+	std::string text(27 * n, '\n'), records(16 * n, '\0');
+	for (size_t i = 0 ; i < n ; i++) {
+		ulid::MarshalTo(ulids[i], &text[27 * i]);
+		ulid::MarshalBinaryTo(ulids[i], reinterpret_cast<uint8_t*>(&records[16 * i]));
+	}
+	return std::make_pair(text, records);
+}
+
+// StringReader and StringWriter stand in for the file descriptors of ulidtool.
+struct StringReader {
+	const std::string& src;
+	size_t pos = 0;
+
+	ptrdiff_t operator()(void* dst, size_t n) {
+		n = std::min(n, src.size() - pos);
+		std::memcpy(dst, src.data() + pos, n);
+		pos += n;
+		return static_cast<ptrdiff_t>(n);
+	}
+};
+
+struct StringWriter {
+	std::string& dst;
+
+	bool operator()(const void* src, size_t n) {
+		dst.append(static_cast<const char*>(src), n);
+		return true;
+	}
+};
+
+// bytes processed is the size of the text, in or out
+static void GetlineUnmarshal(benchmark::State& state) {
+	auto input = StreamInput(state.range(0));
+
+	std::string out;
+	while (state.KeepRunning()) {
+		std::istringstream in(input.first);
+		out.clear();
+		std::string line;
+		uint8_t record[16];
+		while (std::getline(in, line)) {
+			ulid::MarshalBinaryTo(ulid::Unmarshal(line), record);
+			out.append(reinterpret_cast<const char*>(record), 16);
+		}
+		benchmark::DoNotOptimize(out.data());
+	}
+	state.SetBytesProcessed(state.iterations() * input.first.size());
+}
+
+BENCHMARK(GetlineUnmarshal)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+static void TextToBinary(benchmark::State& state) {
+	auto input = StreamInput(state.range(0));
+
+	std::string out;
+	while (state.KeepRunning()) {
+		out.clear();
+		ulid::stream::Result result = ulid::stream::TextToBinary(StringReader{input.first}, StringWriter{out});
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetBytesProcessed(state.iterations() * input.first.size());
+}
+
+BENCHMARK(TextToBinary)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+static void MarshalLinesOstream(benchmark::State& state) {
+	auto input = StreamInput(state.range(0));
+
+	while (state.KeepRunning()) {
+		std::ostringstream out;
+		for (size_t i = 0 ; i < input.second.size() ; i += 16) {
+			out << ulid::Marshal(ulid::UnmarshalBinary(*reinterpret_cast<const uint8_t(*)[16]>(&input.second[i]))) << '\n';
+		}
+		benchmark::DoNotOptimize(out);
+	}
+	state.SetBytesProcessed(state.iterations() * input.first.size());
+}
+
+BENCHMARK(MarshalLinesOstream)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+static void BinaryToText(benchmark::State& state) {
+	auto input = StreamInput(state.range(0));
+
+	std::string out;
+	while (state.KeepRunning()) {
+		out.clear();
+		ulid::stream::Result result = ulid::stream::BinaryToText(StringReader{input.second}, StringWriter{out});
+		benchmark::DoNotOptimize(result);
+	}
+	state.SetBytesProcessed(state.iterations() * input.first.size());
+}
+
+BENCHMARK(BinaryToText)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+
+// bytes processed is the size of the ULID column read
+static void TimeLoop(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids = SortInput(state.range(0));
+
+	std::vector<int64_t> times(ulids.size());
+	while (state.KeepRunning()) {
+		for (size_t i = 0 ; i < ulids.size() ; i++) {
+			times[i] = ulid::Time(ulids[i]);
+		}
+		benchmark::DoNotOptimize(times.data());
+	}
+	state.SetBytesProcessed(state.iterations() * ulids.size() * sizeof(ulid::ULID));
+}
+
+BENCHMARK(TimeLoop)->Arg(1 << 12)->Arg(1 << 24);
+
+static void ExtractTimes(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids = SortInput(state.range(0));
+
+	std::vector<int64_t> times(ulids.size());
+	while (state.KeepRunning()) {
+		ulid::ExtractTimes(ulids.data(), ulids.size(), times.data());
+		benchmark::DoNotOptimize(times.data());
+	}
+	state.SetBytesProcessed(state.iterations() * ulids.size() * sizeof(ulid::ULID));
+}
+
+BENCHMARK(ExtractTimes)->Arg(1 << 12)->Arg(1 << 24);
+
+// per minute counts of a day of ULIDs
+static void BucketCountsLoop(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids = SortInput(state.range(0));
+
+	// the bucket width is a parameter, as it would be for a caller
+	std::vector<uint64_t> counts(1440);
+	int64_t bucket_ms = 60000;
+	benchmark::DoNotOptimize(bucket_ms);
+	while (state.KeepRunning()) {
+		for (size_t i = 0 ; i < ulids.size() ; i++) {
+			uint64_t x = ulid::Time(ulids[i]) - 1484581420000;
+			if (x < 86400000) {
+				counts[x / bucket_ms]++;
+			}
+		}
+		benchmark::DoNotOptimize(counts.data());
+	}
+	state.SetBytesProcessed(state.iterations() * ulids.size() * sizeof(ulid::ULID));
+}
+
+BENCHMARK(BucketCountsLoop)->Arg(1 << 12)->Arg(1 << 24);
+
+static void BucketCounts(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids = SortInput(state.range(0));
+
+	std::vector<uint64_t> counts(1440);
+	while (state.KeepRunning()) {
+		ulid::BucketCounts(ulids.data(), ulids.size(), 60000, 1484581420000, counts.data(), counts.size());
+		benchmark::DoNotOptimize(counts.data());
+	}
+	state.SetBytesProcessed(state.iterations() * ulids.size() * sizeof(ulid::ULID));
+}
+
+BENCHMARK(BucketCounts)->Arg(1 << 12)->Arg(1 << 24);
+
+static void CopyULIDs(benchmark::State& state) {
+	std::vector<ulid::ULID> ulids(state.range(0));
+	ulid::GenerateBatch(ulids.data(), ulids.size());
+
+	std::vector<ulid::ULID> scratch(ulids.size());
+	while (state.KeepRunning()) {
+		std::copy(ulids.begin(), ulids.end(), scratch.begin());
+		benchmark::DoNotOptimize(scratch.data());
+	}
+	state.SetBytesProcessed(state.iterations() * ulids.size() * sizeof(ulid::ULID));
+}
+
+BENCHMARK(CopyULIDs)->Arg(10000000)->Unit(benchmark::kMillisecond);
+
+// live_bytes is the memory held by the containers using CountingAllocator,
+// as requested, before malloc's own overhead.
+static size_t live_bytes = 0;
+
+template <class T>
+struct CountingAllocator {
+	typedef T value_type;
+
+	CountingAllocator() = default;
+
+	template <class U>
+	CountingAllocator(const CountingAllocator<U>&) {}
+
+	T* allocate(size_t n) {
+		live_bytes += n * sizeof(T);
+		return std::allocator<T>().allocate(n);
+	}
+
+	void deallocate(T* p, size_t n) {
+		live_bytes -= n * sizeof(T);
+		std::allocator<T>().deallocate(p, n);
+	}
+
+	friend bool operator==(const CountingAllocator&, const CountingAllocator&) {
+		return true;
+	}
+
+	friend bool operator!=(const CountingAllocator&, const CountingAllocator&) {
+		return false;
+	}
+};
+
+typedef std::unordered_set<ulid::ULID, ulid::Hash, std::equal_to<ulid::ULID>, CountingAllocator<ulid::ULID>>
+	UnorderedUlidSet;
+
+static size_t SetBytes(const ulid::UlidFlatSet& set) {
+	return set.AllocatedBytes();
+}
+
+static size_t SetBytes(const UnorderedUlidSet&) {
+	return live_bytes;
+}
+
+// The keys are streamed from a CounterGenerator a block at a time, rather than
+// kept in a vector next to the set, so 100M entries fit in memory. Generating
+// them costs about 8 ns per ULID, included in every one of these timings.
+template <class Set>
+static void FillSet(Set& set, size_t n) {
+	ulid::CounterGenerator gen(42);
+	std::vector<ulid::ULID> block(4096);
+	for (size_t i = 0 ; i < n ; i += block.size()) {
+		const size_t m = std::min(block.size(), n - i);
+		gen.Fill(block.data(), m);
+		for (size_t j = 0 ; j < m ; j++) {
+			set.insert(block[j]);
+		}
+	}
+}
+
+// Lookup counts the keys of stream that are in set, the inserted keys for
+// stream 0 and keys that are not there for stream 1.
+template <class Set>
+static size_t Lookup(const Set& set, size_t n, uint64_t stream) {
+	ulid::CounterGenerator gen(42, stream);
+	std::vector<ulid::ULID> block(4096);
+	size_t found = 0;
+	for (size_t i = 0 ; i < n ; i += block.size()) {
+		const size_t m = std::min(block.size(), n - i);
+		gen.Fill(block.data(), m);
+		for (size_t j = 0 ; j < m ; j++) {
+			found += set.count(block[j]);
+		}
+	}
+	return found;
+}
+
+template <class Set>
+static void SetInsert(benchmark::State& state) {
+	const size_t n = state.range(0);
+	size_t bytes = 0;
+	while (state.KeepRunning()) {
+		Set set;
+		FillSet(set, n);
+		bytes = SetBytes(set);
+	}
+	state.counters["time/ID"] = benchmark::Counter(
+		state.iterations() * n,
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+	state.counters["bytes/ID"] = static_cast<double>(bytes) / n;
+}
+
+template <class Set>
+static void SetLookup(benchmark::State& state) {
+	const size_t n = state.range(0);
+	Set set;
+	FillSet(set, n);
+	while (state.KeepRunning()) {
+		benchmark::DoNotOptimize(Lookup(set, n, 0));
+	}
+	state.counters["time/ID"] = benchmark::Counter(
+		state.iterations() * n,
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+template <class Set>
+static void SetLookupMiss(benchmark::State& state) {
+	const size_t n = state.range(0);
+	Set set;
+	FillSet(set, n);
+	while (state.KeepRunning()) {
+		benchmark::DoNotOptimize(Lookup(set, n, 1));
+	}
+	state.counters["time/ID"] = benchmark::Counter(
+		state.iterations() * n,
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+BENCHMARK_TEMPLATE(SetInsert, ulid::UlidFlatSet)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(SetInsert, UnorderedUlidSet)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(SetLookup, ulid::UlidFlatSet)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(SetLookup, UnorderedUlidSet)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(SetLookupMiss, ulid::UlidFlatSet)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(SetLookupMiss, UnorderedUlidSet)->Arg(1000000)->Arg(10000000)->Arg(100000000)->Unit(benchmark::kMillisecond);
+
+// The ULIDs of a stream created at 5M per second, 5000 per ms of their
+// timestamps, with one in 20 a replay of one of the block before. The window
+// is filled before timing, so the buckets are dropped and reused at the rate
+// they would be under a sustained load. items/s above 5M is headroom.
+static void FillStream(ulid::CounterGenerator& gen, std::vector<ulid::ULID>& block) {
+	gen.Fill(block.data(), block.size());
+	for (size_t i = 0 ; i < block.size() ; i += 20) {
+		block[i] = block[(i + block.size() / 2) % block.size()];
+	}
+}
+
+static void WindowedDeduper(benchmark::State& state) {
+	const int64_t window_ms = state.range(0);
+	const bool batch = state.range(1) != 0;
+	ulid::WindowedDeduper dedup(window_ms);
+	ulid::CounterGenerator gen(42, 0, 1484581420000, 5000);
+	std::vector<ulid::ULID> block(4096);
+	std::unique_ptr<bool[]> fresh(new bool[block.size()]);
+
+	for (uint64_t warm = 0 ; warm < static_cast<uint64_t>(window_ms + dedup.BucketMs()) * 5000 ; warm += block.size()) {
+		FillStream(gen, block);
+		dedup.insert_if_absent(block.data(), block.size(), nullptr);
+	}
+
+	uint64_t fresh_ids = 0;
+	while (state.KeepRunning()) {
+		state.PauseTiming();
+		FillStream(gen, block);
+		state.ResumeTiming();
+		if (batch) {
+			fresh_ids += dedup.insert_if_absent(block.data(), block.size(), fresh.get());
+		} else {
+			for (size_t i = 0 ; i < block.size() ; i++) {
+				fresh_ids += dedup.insert_if_absent(block[i]) ? 1 : 0;
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * block.size());
+	state.counters["time/ID"] = benchmark::Counter(
+		state.iterations() * block.size(),
+		benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+	state.counters["fresh"] = static_cast<double>(fresh_ids) / (state.iterations() * block.size());
+	state.counters["window IDs"] = static_cast<double>(dedup.size());
+	state.counters["MB"] = static_cast<double>(dedup.AllocatedBytes()) / (1 << 20);
+	state.counters["bytes/ID"] = static_cast<double>(dedup.AllocatedBytes()) / dedup.size();
+}
+
+BENCHMARK(WindowedDeduper)->Args({1000, 0})->Args({1000, 1})->Args({10000, 0})->Args({10000, 1})->Unit(benchmark::kMicrosecond);
+
 BENCHMARK_MAIN();
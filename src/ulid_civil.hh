@@ -0,0 +1,136 @@
+#ifndef ULID_CIVIL_HH
+#define ULID_CIVIL_HH
+
+#include <cstdint>
+#include <cstring>
+
+namespace ulid {
+namespace civil {
+
+/**
+ * DaysFromCivil returns the number of days from 1970-01-01 to the passed date
+ * in the proleptic Gregorian calendar, month and day counting from 1.
+ *
+ * http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+ * */
+inline int64_t DaysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);               // [0, 399]
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;   // [0, 365]
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;              // [0, 146096]
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+/**
+ * CivilFromDays is the inverse of DaysFromCivil.
+ *
+ * http://howardhinnant.github.io/date_algorithms.html#civil_from_days
+ * */
+inline void CivilFromDays(int64_t z, int64_t& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    unsigned doe = static_cast<unsigned>(z - era * 146097);                 // [0, 146096]
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;  // [0, 399]
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);                // [0, 365]
+    unsigned mp = (5 * doy + 2) / 153;                                     // [0, 11]
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+}
+
+inline void PutDigits2(unsigned v, char* dst) {
+    dst[0] = static_cast<char>('0' + v / 10);
+    dst[1] = static_cast<char>('0' + v % 10);
+}
+
+inline unsigned GetDigits2(const char* src) {
+    return static_cast<unsigned>(src[0] - '0') * 10 + static_cast<unsigned>(src[1] - '0');
+}
+
+/**
+ * EncodeSeconds writes the seconds since the Unix epoch as the 15 characters
+ * YYYYmmddTHHMMSS, in UTC.
+ *
+ * ULID timestamps are 48 bit and never negative, so everything after the split
+ * into days and seconds fits in 32 bit unsigned arithmetic. They also reach
+ * past the year 9999, those years are written modulo 10000.
+ * */
+inline void EncodeSeconds(uint64_t seconds, char dst[15]) {
+    uint32_t days = static_cast<uint32_t>(seconds / 86400);
+    uint32_t t = static_cast<uint32_t>(seconds % 86400);
+
+    // CivilFromDays, for days on or after 1970-01-01, with the divisions by 1461
+    // and 153 replaced by multiplications as in Neri and Schneider, "Euclidean
+    // affine functions and their application to calendar algorithms" (2022).
+    uint32_t n1 = 4 * (days + 719468) + 3;
+    uint32_t c = n1 / 146097;
+    uint32_t nc = n1 % 146097 / 4;
+
+    uint64_t p2 = uint64_t(2939745) * (4 * nc + 3);
+    uint32_t z = static_cast<uint32_t>(p2 >> 32);
+    uint32_t ny = static_cast<uint32_t>(p2) / 2939745 / 4;
+
+    uint32_t n3 = 2141 * ny + 197913;
+    uint32_t j = ny >= 306;
+    uint32_t m = (n3 >> 16) - 12 * j;
+    uint32_t d = (n3 & 0xFFFF) / 2141 + 1;
+    uint32_t year = (100 * c + z + j) % 10000;
+
+    PutDigits2(year / 100, dst);
+    PutDigits2(year % 100, dst + 2);
+    PutDigits2(m, dst + 4);
+    PutDigits2(d, dst + 6);
+    dst[8] = 'T';
+
+    PutDigits2(t / 3600, dst + 9);
+    PutDigits2(t / 60 % 60, dst + 11);
+    PutDigits2(t % 60, dst + 13);
+}
+
+/**
+ * EncodeTimestamp writes the milliseconds since the Unix epoch as the 19 characters
+ * YYYYmmddTHHMMSSsssZ, in UTC.
+ *
+ * IDs that are printed together tend to be from the same second, so each thread
+ * keeps the characters of the last second it encoded and only the milliseconds
+ * are converted when it repeats.
+ * */
+inline void EncodeTimestamp(uint64_t ms, char dst[19]) {
+    struct Last {
+        uint64_t seconds = ~uint64_t(0);
+        char chars[16];
+    };
+    static thread_local Last last;
+
+    uint64_t seconds = ms / 1000;
+    uint32_t msec = static_cast<uint32_t>(ms % 1000);
+    if (seconds != last.seconds) {
+        EncodeSeconds(seconds, last.chars);
+        last.seconds = seconds;
+    }
+
+    std::memcpy(dst, last.chars, 15);
+    dst[15] = static_cast<char>('0' + msec / 100);
+    PutDigits2(msec % 100, dst + 16);
+    dst[18] = 'Z';
+}
+
+/**
+ * DecodeTimestamp reads the 19 characters YYYYmmddTHHMMSSsssZ as milliseconds
+ * since the Unix epoch. Like UnmarshalFrom, the input is not validated.
+ * */
+inline int64_t DecodeTimestamp(const char src[19]) {
+    int64_t y = GetDigits2(src) * 100 + GetDigits2(src + 2);
+    int64_t days = DaysFromCivil(y, GetDigits2(src + 4), GetDigits2(src + 6));
+
+    int64_t seconds = GetDigits2(src + 9) * 3600 + GetDigits2(src + 11) * 60 + GetDigits2(src + 13);
+    int64_t msec = static_cast<int64_t>(src[15] - '0') * 100 + GetDigits2(src + 16);
+
+    return (days * 86400 + seconds) * 1000 + msec;
+}
+
+};  // namespace civil
+};  // namespace ulid
+
+#endif // ULID_CIVIL_HH
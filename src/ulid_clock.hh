@@ -0,0 +1,193 @@
+#ifndef ULID_CLOCK_HH
+#define ULID_CLOCK_HH
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#define ULID_HAS_CLOCK_GETTIME
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace ulid {
+namespace clocks {
+
+/**
+ * A clock is any type with an int64_t Now() member returning milliseconds since
+ * the Unix epoch. Clocks that can serve as the wall clock of a TscClock also
+ * have an int64_t NowNs() member returning nanoseconds since the epoch.
+ *
+ * The clocks in this file are stateless (TscClock keeps its state per thread),
+ * so one instance can be shared by many threads.
+ * */
+
+/**
+ * SystemClock reads std::chrono::system_clock::now().
+ * */
+struct SystemClock {
+    int64_t NowNs() {
+        auto now = std::chrono::system_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(now.time_since_epoch()).count();
+    }
+
+    int64_t Now() {
+        auto now = std::chrono::system_clock::now();
+        return std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    }
+};
+
+/**
+ * RealtimeClock reads clock_gettime(CLOCK_REALTIME), which Linux serves from the
+ * vDSO without entering the kernel. Falls back to SystemClock elsewhere.
+ * */
+struct RealtimeClock {
+    int64_t NowNs() {
+#if defined(ULID_HAS_CLOCK_GETTIME)
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+        return SystemClock().NowNs();
+#endif
+    }
+
+    int64_t Now() {
+#if defined(ULID_HAS_CLOCK_GETTIME)
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return int64_t(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#else
+        return SystemClock().Now();
+#endif
+    }
+};
+
+/**
+ * CoarseClock reads clock_gettime(CLOCK_REALTIME_COARSE), the time of the last
+ * timer tick. It is a plain memory read in the vDSO, but only advances once per
+ * tick (1 to 4 ms depending on the kernel's HZ), so consecutive milliseconds can
+ * be skipped. Falls back to RealtimeClock where it is not available.
+ * */
+struct CoarseClock {
+    int64_t NowNs() {
+#if defined(CLOCK_REALTIME_COARSE)
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+        return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+#else
+        return RealtimeClock().NowNs();
+#endif
+    }
+
+    int64_t Now() {
+#if defined(CLOCK_REALTIME_COARSE)
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+        return int64_t(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+#else
+        return RealtimeClock().Now();
+#endif
+    }
+};
+
+/**
+ * Ticks reads the CPU's time stamp counter, or std::chrono::steady_clock where
+ * there is none.
+ * */
+inline uint64_t Ticks() {
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    return __builtin_ia32_rdtsc();
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * TscClock extrapolates the wall clock from the CPU's time stamp counter and
+ * only reads Wall once every ResyncNs.
+ *
+ * Each thread anchors a (ticks, wall time) pair and measures the tick rate
+ * between resyncs. Until the rate is known, roughly CalibrationNs after the
+ * first call, every call reads Wall.
+ *
+ * Each resync re-anchors to Wall, so steps of the wall clock (NTP, settimeofday)
+ * show up within ResyncNs, backwards steps included. A resync whose measured rate
+ * is more than 1% off is treated as such a step and does not touch the rate.
+ * */
+template <class Wall = RealtimeClock>
+class TscClock {
+public:
+    static const int64_t ResyncNs = 100000000;
+    static const int64_t CalibrationNs = 10000000;
+
+    int64_t NowNs() {
+        State& s = ThreadState();
+        uint64_t ticks = Ticks();
+        if (s.ns_per_tick == 0 || ticks - s.anchor_ticks >= s.resync_ticks) {
+            return Resync(s, ticks);
+        }
+        return s.anchor_ns + static_cast<int64_t>(static_cast<double>(ticks - s.anchor_ticks) * s.ns_per_tick);
+    }
+
+    int64_t Now() {
+        int64_t ns = NowNs();
+        return ns / 1000000;
+    }
+
+private:
+    struct State {
+        uint64_t anchor_ticks = 0;
+        int64_t anchor_ns = 0;
+        uint64_t resync_ticks = 0;
+        double ns_per_tick = 0;
+    };
+
+    static State& ThreadState() {
+        static thread_local State state;
+        return state;
+    }
+
+    static int64_t Resync(State& s, uint64_t ticks) {
+        int64_t ns = Wall().NowNs();
+        int64_t elapsed = ns - s.anchor_ns;
+
+        if (s.anchor_ns != 0 && ticks > s.anchor_ticks) {
+            double rate = static_cast<double>(elapsed) / static_cast<double>(ticks - s.anchor_ticks);
+            if (s.ns_per_tick == 0) {
+                if (elapsed >= 0 && elapsed < CalibrationNs) {
+                    // keep the first anchor until the interval is long enough to measure
+                    return ns;
+                }
+                if (rate > 0) {
+                    s.ns_per_tick = rate;
+                }
+            } else if (rate > s.ns_per_tick * 0.99 && rate < s.ns_per_tick * 1.01) {
+                s.ns_per_tick = rate;
+            }
+        }
+
+        s.anchor_ticks = ticks;
+        s.anchor_ns = ns;
+        if (s.ns_per_tick != 0) {
+            s.resync_ticks = static_cast<uint64_t>(ResyncNs / s.ns_per_tick);
+        }
+        return ns;
+    }
+};
+
+/**
+ * DefaultClock is used by EncodeTimeNow and everything built on it.
+ * */
+typedef RealtimeClock DefaultClock;
+
+};  // namespace clocks
+};  // namespace ulid
+
+#endif // ULID_CLOCK_HH
@@ -0,0 +1,178 @@
+#ifndef ULID_COLUMN_HH
+#define ULID_COLUMN_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "ulid_core.hh"
+
+namespace ulid {
+
+namespace column {
+
+/**
+ * Block is the number of timestamps BucketCounts extracts at a time, on the stack.
+ * */
+inline constexpr size_t Block = 256;
+
+#ifdef ULID_BASE32_SIMD
+
+/**
+ * TimeShuffle moves the 48 bit timestamp of a 16 byte ULID into one 64 bit half
+ * of the register, zero extended, [0] into the low half and [1] into the high.
+ *
+ * For big endian storage (the order of MarshalBinaryTo) the timestamp is bytes
+ * 0 to 5, most significant first, for a little endian 128 bit integer it is
+ * bytes 10 to 15, least significant first. Indexed by LittleEndian.
+ * */
+alignas(16) inline constexpr uint8_t TimeShuffle[2][2][16] = {
+    {
+        {0x05, 0x04, 0x03, 0x02, 0x01, 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+        {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x05, 0x04, 0x03, 0x02, 0x01, 0x00, 0x80, 0x80},
+    },
+    {
+        {0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80},
+        {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x80, 0x80},
+    },
+};
+
+/**
+ * ExtractTimesSSE41 writes the timestamps of the n consecutive 16 byte ULIDs at
+ * src, two per iteration, and returns how many it wrote (n rounded down to even).
+ * */
+template <bool LittleEndian>
+ULID_TARGET_SSE41 inline size_t ExtractTimesSSE41(const void* src, size_t n, int64_t* out) {
+    const __m128i* p = static_cast<const __m128i*>(src);
+    const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(TimeShuffle[LittleEndian][0]));
+    const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(TimeShuffle[LittleEndian][1]));
+
+    size_t i = 0;
+    for ( ; i + 2 <= n ; i += 2) {
+        const __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(p + i), lo);
+        const __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(p + i + 1), hi);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_or_si128(a, b));
+    }
+    return i;
+}
+
+/**
+ * ExtractTimesAVX2 does four ULIDs per iteration. The first pair lands in the
+ * low halves of the 128 bit lanes and the second in the high halves, giving
+ * timestamps 0 2 1 3, which a cross lane permute puts back in order.
+ * */
+template <bool LittleEndian>
+ULID_TARGET_AVX2 inline size_t ExtractTimesAVX2(const void* src, size_t n, int64_t* out) {
+    const __m256i* p = static_cast<const __m256i*>(src);
+    const __m256i lo = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(TimeShuffle[LittleEndian][0])));
+    const __m256i hi = _mm256_broadcastsi128_si256(
+        _mm_load_si128(reinterpret_cast<const __m128i*>(TimeShuffle[LittleEndian][1])));
+
+    size_t i = 0;
+    for ( ; i + 4 <= n ; i += 4) {
+        const __m256i a = _mm256_shuffle_epi8(_mm256_loadu_si256(p + i / 2), lo);
+        const __m256i b = _mm256_shuffle_epi8(_mm256_loadu_si256(p + i / 2 + 1), hi);
+        const __m256i t = _mm256_permute4x64_epi64(_mm256_or_si256(a, b), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), t);
+    }
+    return i;
+}
+
+#endif // ULID_BASE32_SIMD
+
+/**
+ * ExtractTimes writes the timestamps of the first ULIDs of the n at src with the
+ * widest available kernel, and returns how many. The rest are left to the caller.
+ * */
+template <bool LittleEndian>
+inline size_t ExtractTimes(const void* src, size_t n, int64_t* out) {
+#ifdef ULID_BASE32_SIMD
+    int level = base32::SimdLevel();
+    if (level >= base32::LevelAVX2) {
+        return ExtractTimesAVX2<LittleEndian>(src, n, out);
+    }
+    if (level >= base32::LevelSSE41) {
+        return ExtractTimesSSE41<LittleEndian>(src, n, out);
+    }
+#else
+    (void)src;
+    (void)n;
+    (void)out;
+#endif // ULID_BASE32_SIMD
+    return 0;
+}
+
+};  // namespace column
+
+namespace core {
+
+/**
+ * ExtractTimes writes the timestamps of n ULIDs to out, the same values as
+ * Time, with a byte shuffle kernel handling two or four ULIDs per instruction
+ * where the machine has one.
+ * */
+template <class ULID>
+inline void ExtractTimes(const ULID* ulids, size_t n, int64_t* out) {
+    size_t i = column::ExtractTimes<Storage<ULID>::LittleEndian>(ulids, n, out);
+    for ( ; i < n ; i++) {
+        out[i] = static_cast<int64_t>(Time(ulids[i]));
+    }
+}
+
+/**
+ * BucketCounts adds to counts[k] the number of the n ULIDs with a timestamp in
+ * [start_ms + k * bucket_ms, start_ms + (k + 1) * bucket_ms), for k below buckets,
+ * and returns how many ULIDs were counted. Timestamps outside of the buckets are
+ * skipped. counts is not cleared first, so a column can be counted in pieces.
+ *
+ * Timestamps are extracted a block at a time with ExtractTimes. With 128 bit
+ * integers the bucket is the high half of a multiply by 2^64 / bucket_ms
+ * rounded up, exact while offset * bucket_ms stays below 2^64, which holds
+ * for any span of buckets up to 2^64 / bucket_ms. Wider spans, and compilers
+ * without 128 bit integers, divide. bucket_ms must be positive.
+ * */
+template <class ULID>
+inline size_t BucketCounts(const ULID* ulids, size_t n, int64_t bucket_ms, int64_t start_ms,
+                           uint64_t* counts, size_t buckets) {
+    const uint64_t d = static_cast<uint64_t>(bucket_ms);
+    const uint64_t span = buckets > std::numeric_limits<uint64_t>::max() / d
+        ? std::numeric_limits<uint64_t>::max()
+        : d * buckets;
+
+#if defined(__SIZEOF_INT128__)
+    const bool multiply = d > 1 && span <= std::numeric_limits<uint64_t>::max() / d;
+    const uint64_t inverse = multiply ? static_cast<uint64_t>((__uint128_t(1) << 64) / d) + 1 : 0;
+#endif
+
+    size_t counted = 0;
+    int64_t times[column::Block];
+    for (size_t i = 0 ; i < n ; i += column::Block) {
+        const size_t m = std::min(n - i, column::Block);
+        ExtractTimes(ulids + i, m, times);
+
+        for (size_t j = 0 ; j < m ; j++) {
+            const uint64_t x = static_cast<uint64_t>(times[j]) - static_cast<uint64_t>(start_ms);
+            if (x >= span) {
+                continue;
+            }
+#if defined(__SIZEOF_INT128__)
+            if (multiply) {
+                counts[static_cast<uint64_t>((__uint128_t(x) * inverse) >> 64)]++;
+                counted++;
+                continue;
+            }
+#endif
+            counts[x / d]++;
+            counted++;
+        }
+    }
+    return counted;
+}
+
+};  // namespace core
+
+};  // namespace ulid
+
+#endif // ULID_COLUMN_HH
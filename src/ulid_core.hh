@@ -0,0 +1,1216 @@
+#ifndef ULID_CORE_HH
+#define ULID_CORE_HH
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <ostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ulid_base32.hh"
+#include "ulid_civil.hh"
+#include "ulid_clock.hh"
+#include "ulid_entropy.hh"
+
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L
+#include <compare>
+#include <span>
+#if defined(__has_include)
+#if __has_include(<format>)
+#include <format>
+#endif
+#endif
+#endif
+
+#if defined(ULID_WITH_FMT)
+#include <fmt/format.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <stdlib.h>
+#endif
+
+#if _MSC_VER > 0
+typedef uint32_t rand_t;
+# else
+typedef uint8_t rand_t;
+#endif
+
+// Define ULID_NO_CAS128 to keep the sharded MonotonicGenerator state even
+// where the 128 bit compare and swap is available.
+#if !defined(ULID_NO_CAS128) && defined(__SIZEOF_INT128__) && (defined(__GNUC__) || defined(__clang__))
+#define ULID_HAS_CAS128
+#if defined(__x86_64__)
+// cmpxchg16b is not part of the x86-64 baseline, so it is enabled per function
+// instead of asking every user to build with -mcx16.
+#define ULID_CAS128_TARGET __attribute__((target("cx16")))
+#else
+#define ULID_CAS128_TARGET
+#endif
+#endif
+
+namespace ulid {
+
+/**
+ * Storage describes how a ULID representation holds its 128 bits. The functions
+ * in namespace core only touch a ULID through it, so a representation gets the
+ * whole API by specializing it:
+ *
+ *     template <>
+ *     struct Storage<U> {
+ *         // byte order of the 16 bytes in memory, for the ulid_base32.hh kernels
+ *         static constexpr bool LittleEndian;
+ *
+ *         // the top and bottom 64 bits
+ *         static constexpr uint64_t Hi(const U&);
+ *         static constexpr uint64_t Lo(const U&);
+ *         static constexpr void Set(U&, uint64_t hi, uint64_t lo);
+ *
+ *         // the 48 bit timestamp at the top of Hi
+ *         static constexpr time_t Time(const U&);
+ *         static constexpr void SetTime(U&, time_t);
+ *
+ *         // the 16 bytes in big endian order, see MarshalBinaryTo
+ *         static void ToBytes(const U&, uint8_t dst[16]);
+ *         static void FromBytes(const uint8_t src[16], U&);
+ *     };
+ *
+ * ulid_uint128.hh, ulid_u64pair.hh and ulid_struct.hh each specialize it for
+ * their representation.
+ * */
+template <class ULID>
+struct Storage {};
+
+/**
+ * IsULID tells whether Storage is specialized for a type.
+ * */
+template <class T, class = void>
+struct IsULID : std::false_type {};
+
+template <class T>
+struct IsULID<T, typename entropy::Void<decltype(Storage<T>::Hi(std::declval<const T&>()))>::type> : std::true_type {};
+
+/**
+ * ByteSwap64 reverses the bytes of a 64 bit integer.
+ * */
+inline uint64_t ByteSwap64(uint64_t v) {
+#if defined(_MSC_VER)
+    return _byteswap_uint64(v);
+#else
+    return __builtin_bswap64(v);
+#endif
+}
+
+/**
+ * LoadBigEndian64 reads 8 bytes as a big endian 64 bit integer.
+ * */
+inline uint64_t LoadBigEndian64(const uint8_t* b) {
+    uint64_t v;
+    std::memcpy(&v, b, 8);
+    return base32::HostLittleEndian ? ByteSwap64(v) : v;
+}
+
+/**
+ * StoreBigEndian64 writes a 64 bit integer as 8 big endian bytes.
+ * */
+inline void StoreBigEndian64(uint64_t v, uint8_t* b) {
+    v = base32::HostLittleEndian ? ByteSwap64(v) : v;
+    std::memcpy(b, &v, 8);
+}
+
+/**
+ * DefaultGenerator returns the std::mt19937 owned by the calling thread.
+ *
+ * It is seeded from std::random_device the first time a thread asks for it.
+ * */
+inline std::mt19937& DefaultGenerator() {
+    static thread_local std::mt19937 generator{ std::random_device{}() };
+    return generator;
+}
+
+/**
+ * Crockford's Base32
+ * */
+inline constexpr char Encoding[33] = "0123456789ABCDEFGHJKMNPQRSTVWXYZ";
+
+/**
+ * dec storesdecimal encodings for characters.
+ * 0xFF indicates invalid character.
+ * 48-57 are digits.
+ * 65-90 are capital alphabets.
+ * */
+inline constexpr uint8_t dec[256] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    /* 0     1     2     3     4     5     6     7  */
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    /* 8     9                                      */
+    0x08, 0x09, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    /*    10(A) 11(B) 12(C) 13(D) 14(E) 15(F) 16(G) */
+    0xFF, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F, 0x10,
+    /*17(H)     18(J) 19(K)       20(M) 21(N)       */
+    0x11, 0xFF, 0x12, 0x13, 0xFF, 0x14, 0x15, 0xFF,
+    /*22(P)23(Q)24(R) 25(S) 26(T)       27(V) 28(W) */
+    0x16, 0x17, 0x18, 0x19, 0x1A, 0xFF, 0x1B, 0x1C,
+    /*29(X)30(Y)31(Z)                               */
+    0x1D, 0x1E, 0x1F, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+/**
+ * ValidLiteral reports whether str[0, len) is a ULID the way MarshalTo writes it,
+ * 26 characters of the uppercase alphabet with a first character of at most '7'.
+ * */
+inline constexpr bool ValidLiteral(const char* str, size_t len) {
+    if (len != 26 || str[0] > '7') {
+        return false;
+    }
+    for (size_t i = 0 ; i < len ; i++) {
+        if (dec[static_cast<uint8_t>(str[i])] == 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * LiteralChars holds the characters of a _ulid literal taken as template
+ * arguments, see ULID_LITERAL_TEMPLATE.
+ * */
+template <class C, C... chars>
+struct LiteralChars {
+    static constexpr char str[] = {static_cast<char>(chars)..., '\0'};
+};
+
+/**
+ * InvalidLiteral is deliberately not constexpr, calling it during constant
+ * evaluation is what turns a malformed _ulid literal into a compile error.
+ * */
+[[noreturn]] inline void InvalidLiteral() {
+    std::abort();
+}
+
+/**
+ * EncodeWords writes the 26 characters for the ULID with top 64 bits hi and
+ * bottom 64 bits lo to dst.
+ *
+ * Character 0 is the top 3 bits and character k the 5 bits starting at bit
+ * 125 - 5k, so characters 1 to 12 come from the high word, 14 to 25 from the
+ * low word, and character 13 takes the lowest bit of one and the top 4 of the
+ * other.
+ * */
+inline constexpr void EncodeWords(uint64_t hi, uint64_t lo, char dst[26]) {
+    // 10 byte timestamp
+    dst[0] = Encoding[hi >> 61];
+    dst[1] = Encoding[(hi >> 56) & 31];
+    dst[2] = Encoding[(hi >> 51) & 31];
+    dst[3] = Encoding[(hi >> 46) & 31];
+    dst[4] = Encoding[(hi >> 41) & 31];
+    dst[5] = Encoding[(hi >> 36) & 31];
+    dst[6] = Encoding[(hi >> 31) & 31];
+    dst[7] = Encoding[(hi >> 26) & 31];
+    dst[8] = Encoding[(hi >> 21) & 31];
+    dst[9] = Encoding[(hi >> 16) & 31];
+
+    // 16 bytes of entropy
+    dst[10] = Encoding[(hi >> 11) & 31];
+    dst[11] = Encoding[(hi >> 6) & 31];
+    dst[12] = Encoding[(hi >> 1) & 31];
+    dst[13] = Encoding[((hi << 4) | (lo >> 60)) & 31];
+    dst[14] = Encoding[(lo >> 55) & 31];
+    dst[15] = Encoding[(lo >> 50) & 31];
+    dst[16] = Encoding[(lo >> 45) & 31];
+    dst[17] = Encoding[(lo >> 40) & 31];
+    dst[18] = Encoding[(lo >> 35) & 31];
+    dst[19] = Encoding[(lo >> 30) & 31];
+    dst[20] = Encoding[(lo >> 25) & 31];
+    dst[21] = Encoding[(lo >> 20) & 31];
+    dst[22] = Encoding[(lo >> 15) & 31];
+    dst[23] = Encoding[(lo >> 10) & 31];
+    dst[24] = Encoding[(lo >> 5) & 31];
+    dst[25] = Encoding[lo & 31];
+}
+
+/**
+ * core holds the one implementation of the API, for any ULID representation
+ * with a Storage specialization. Functions that take a ULID deduce its type,
+ * the ones that return a new ULID take it as the first template argument:
+ *
+ *     ulid::u64pair::ULID id = ulid::core::Create<ulid::u64pair::ULID>(timestamp, rng);
+ *     std::string str = ulid::core::Marshal(id);
+ *
+ * ulid_api.hh exposes it in namespace ulid for the default ULID type.
+ * */
+namespace core {
+
+/**
+ * EncodeTime will encode the first 6 bytes of a uint8_t array to the passed
+ * timestamp
+ * */
+template <class ULID>
+inline constexpr void EncodeTime(time_t timestamp, ULID& ulid) {
+    Storage<ULID>::SetTime(ulid, timestamp);
+}
+
+/**
+ * EncodeTimeNow will encode a ULID using the current time in milliseconds,
+ * read from the passed clock (see ulid_clock.hh).
+ * */
+template <class Clock, class ULID>
+inline void EncodeTimeNow(Clock&& clock, ULID& ulid) {
+    EncodeTime(clock.Now(), ulid);
+}
+
+/**
+ * EncodeTimeNow will encode a ULID using the current time in milliseconds,
+ * read from clocks::DefaultClock.
+ * */
+template <class ULID>
+inline void EncodeTimeNow(ULID& ulid) {
+    EncodeTimeNow(clocks::DefaultClock(), ulid);
+}
+
+/**
+ * EncodeTimeSystemClockNow will encode a ULID using the time obtained using
+ * std::chrono::system_clock::now() by taking the timestamp in milliseconds.
+ * */
+template <class ULID>
+inline void EncodeTimeSystemClockNow(ULID& ulid) {
+    auto now = std::chrono::system_clock::now();
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch());
+    EncodeTime(ms.count(), ulid);
+}
+
+/**
+ * SetEntropy replaces the 80 bits of entropy, the top 16 in hi and the bottom 64 in lo.
+ * */
+template <class ULID>
+inline constexpr void SetEntropy(ULID& ulid, uint16_t hi, uint64_t lo) {
+    Storage<ULID>::Set(ulid, (Storage<ULID>::Hi(ulid) & ~uint64_t(0xFFFF)) | hi, lo);
+}
+
+/**
+ * EncodeEntropy will encode the last 10 bytes of the passed uint8_t array with
+ * the values generated using the passed random number generator.
+ * */
+template <class ULID>
+inline void EncodeEntropy(const std::function<uint8_t()>& rng, ULID& ulid) {
+    uint16_t hi = rng();
+    hi = static_cast<uint16_t>((hi << 8) | rng());
+
+    uint64_t lo = 0;
+    for (int i = 0 ; i < 8 ; i++) {
+        lo = (lo << 8) | rng();
+    }
+
+    SetEntropy(ulid, hi, lo);
+}
+
+/**
+ * EncodeEntropy will encode the last 10 bytes of the ULID with values drawn from
+ * the passed random number generator, called directly instead of through a
+ * std::function so it can be inlined.
+ *
+ * Callables returning a byte are called 10 times, like the std::function version.
+ * Generators with a fill(uint8_t*, size_t) member, and full range 32 or 64 bit
+ * generators such as std::mt19937_64, are asked for all 80 bits in as few draws
+ * as possible (see ulid_entropy.hh).
+ * */
+template <class Rng, class ULID>
+inline void EncodeEntropy(Rng&& rng, ULID& ulid) {
+    uint16_t hi;
+    uint64_t lo;
+    entropy::Draw80(rng, hi, lo);
+    SetEntropy(ulid, hi, lo);
+}
+
+/**
+ * EncodeEntropyRand will encode a ulid using std::rand
+ *
+ * std::rand returns values in [0, RAND_MAX]
+ * */
+template <class ULID>
+inline void EncodeEntropyRand(ULID& ulid) {
+    EncodeEntropy([]() { return static_cast<uint8_t>((std::rand() * 255ull) / RAND_MAX); }, ulid);
+}
+
+/**
+ * EncodeEntropyMt19937 will encode a ulid using std::mt19937
+ *
+ * It also creates a std::uniform_int_distribution to generate values in [0, 255]
+ * */
+template <class ULID>
+inline void EncodeEntropyMt19937(std::mt19937& generator, ULID& ulid) {
+    std::uniform_int_distribution<rand_t> Distribution_0_255(0, 255);
+    EncodeEntropy([&]() { return static_cast<uint8_t>(Distribution_0_255(generator)); }, ulid);
+}
+
+/**
+ * EncodeEntropyMt19937 will encode a ulid using the calling thread's DefaultGenerator.
+ * */
+template <class ULID>
+inline void EncodeEntropyMt19937(ULID& ulid) {
+    EncodeEntropyMt19937(DefaultGenerator(), ulid);
+}
+
+/**
+ * EncodeEntropySecure will encode a ulid using the operating system's CSPRNG,
+ * through the calling thread's entropy::SecureRandom buffer.
+ * */
+template <class ULID>
+inline void EncodeEntropySecure(ULID& ulid) {
+    EncodeEntropy(entropy::SecureRandom(), ulid);
+}
+
+/**
+ * Encode will create an encoded ULID with a timestamp and a generator.
+ * */
+template <class ULID>
+inline void Encode(time_t timestamp, const std::function<uint8_t()>& rng, ULID& ulid) {
+    EncodeTime(timestamp, ulid);
+    EncodeEntropy(rng, ulid);
+}
+
+/**
+ * Encode will create an encoded ULID with a timestamp and a generator, see the
+ * templated EncodeEntropy.
+ * */
+template <class Rng, class ULID>
+inline void Encode(time_t timestamp, Rng&& rng, ULID& ulid) {
+    EncodeTime(timestamp, ulid);
+    EncodeEntropy(rng, ulid);
+}
+
+/**
+ * GenerateNow = EncodeTimeSystemClockNow + EncodeEntropyMt19937
+ * */
+template <class ULID>
+inline void GenerateNow(ULID& ulid) {
+    EncodeTimeSystemClockNow(ulid);
+    EncodeEntropyMt19937(ulid);
+}
+
+/**
+ * GenerateNow = EncodeTimeSystemClockNow + EncodeEntropyMt19937, using a caller owned generator.
+ * */
+template <class ULID>
+inline void GenerateNow(std::mt19937& generator, ULID& ulid) {
+    EncodeTimeSystemClockNow(ulid);
+    EncodeEntropyMt19937(generator, ulid);
+}
+
+/**
+ * EncodeNowRand = EncodeTimeNow + EncodeEntropyRand.
+ * */
+template <class ULID>
+inline void EncodeNowRand(ULID& ulid) {
+    EncodeTimeNow(ulid);
+    EncodeEntropyRand(ulid);
+}
+
+/**
+ * Create will create a ULID with a timestamp and a generator.
+ * */
+template <class ULID>
+inline ULID Create(time_t timestamp, const std::function<uint8_t()>& rng) {
+    ULID ulid{};
+    Encode(timestamp, rng, ulid);
+    return ulid;
+}
+
+/**
+ * Create will create a ULID with a timestamp and a generator, see the templated
+ * EncodeEntropy.
+ * */
+template <class ULID, class Rng>
+inline ULID Create(time_t timestamp, Rng&& rng) {
+    ULID ulid{};
+    Encode(timestamp, rng, ulid);
+    return ulid;
+}
+
+/**
+ * CreateNowRand:EncodeNowRand = Create:Encode.
+ * */
+template <class ULID>
+inline ULID CreateNowRand() {
+    ULID ulid{};
+    EncodeNowRand(ulid);
+    return ulid;
+}
+
+/**
+ * MinULID is the smallest ULID with a timestamp, the entropy all zeros. Every
+ * ULID created in that millisecond or later compares greater or equal.
+ * */
+template <class ULID>
+inline constexpr ULID MinULID(time_t timestamp) {
+    ULID ulid{};
+    Storage<ULID>::Set(ulid, static_cast<uint64_t>(timestamp) << 16, 0);
+    return ulid;
+}
+
+/**
+ * MaxULID is the largest ULID with a timestamp, the entropy all ones. Every
+ * ULID created in that millisecond or earlier compares less or equal, so
+ * [MinULID(from), MaxULID(to)] holds the ULIDs of the window [from, to].
+ * */
+template <class ULID>
+inline constexpr ULID MaxULID(time_t timestamp) {
+    ULID ulid{};
+    Storage<ULID>::Set(ulid, (static_cast<uint64_t>(timestamp) << 16) | 0xFFFF, ~uint64_t(0));
+    return ulid;
+}
+
+/**
+ * GenerateBatch will fill out[0, n) with ULIDs for the current time.
+ *
+ * The clock is read once per block of 256 ULIDs, and the entropy for a whole
+ * block is drawn from the generator into a single buffer (see entropy::Fill),
+ * instead of one clock read and ten generator calls per ULID.
+ * */
+template <class Clock, class Rng, class ULID>
+inline void GenerateBatch(Clock&& clock, Rng&& rng, ULID* out, size_t n) {
+    const size_t block = 256;
+    uint8_t buffer[block * 10];
+
+    while (n > 0) {
+        size_t count = n < block ? n : block;
+        entropy::Fill(rng, buffer, count * 10);
+
+        const uint64_t t = static_cast<uint64_t>(clock.Now()) << 16;
+
+        const uint8_t* e = buffer;
+        for (size_t i = 0 ; i < count ; i++, e += 10) {
+            uint64_t lo;
+            uint16_t hi;
+            std::memcpy(&lo, e, 8);
+            std::memcpy(&hi, e + 8, 2);
+            Storage<ULID>::Set(out[i], t | hi, lo);
+        }
+
+        out += count;
+        n -= count;
+    }
+}
+
+/**
+ * GenerateBatch will fill out[0, n) with ULIDs for the current time, read from
+ * clocks::DefaultClock.
+ * */
+template <class Rng, class ULID>
+inline void GenerateBatch(Rng&& rng, ULID* out, size_t n) {
+    GenerateBatch(clocks::DefaultClock(), rng, out, n);
+}
+
+/**
+ * GenerateBatch will fill out[0, n) with ULIDs for the current time, using the
+ * calling thread's DefaultGenerator.
+ * */
+template <class ULID>
+inline void GenerateBatch(ULID* out, size_t n) {
+    GenerateBatch(DefaultGenerator(), out, n);
+}
+
+/**
+ * MarshalToScalar will marshal a ULID to the passed character array, one
+ * character at a time. It is the fallback and the reference for MarshalTo.
+ * */
+template <class ULID>
+inline constexpr void MarshalToScalar(const ULID& ulid, char dst[26]) {
+    EncodeWords(Storage<ULID>::Hi(ulid), Storage<ULID>::Lo(ulid), dst);
+}
+
+/**
+ * MarshalTo will marshal a ULID to the passed character array.
+ *
+ * Uses the vector kernel in ulid_base32.hh where the CPU supports it, which reads
+ * the ULID in place, and MarshalToScalar otherwise.
+ * */
+template <class ULID>
+inline constexpr void MarshalTo(const ULID& ulid, char dst[26]) {
+#ifdef ULID_BASE32_SIMD
+    if (!ULID_IS_CONSTANT_EVALUATED() && base32::SimdLevel() >= base32::LevelSSE41) {
+        base32::EncodeSSE41<Storage<ULID>::LittleEndian>(&ulid, dst);
+        return;
+    }
+#endif // ULID_BASE32_SIMD
+    MarshalToScalar(ulid, dst);
+}
+
+/**
+ * MarshalBatch will marshal n ULIDs back to back into dst, which must hold
+ * 26 * n characters. No separators or terminators are written.
+ * */
+template <class ULID>
+inline void MarshalBatch(const ULID* ulids, size_t n, char* dst) {
+    if (base32::EncodeBatch<Storage<ULID>::LittleEndian>(ulids, n, dst)) {
+        return;
+    }
+    for (size_t i = 0 ; i < n ; i++) {
+        MarshalToScalar(ulids[i], dst + 26 * i);
+    }
+}
+
+/**
+ * Time will extract the timestamp used to generate a ULID
+ * */
+template <class ULID>
+inline constexpr time_t Time(const ULID& ulid) {
+    return Storage<ULID>::Time(ulid);
+}
+
+/**
+ * MarshalToHuman will marshal a ULID to the passed character array using a human
+ * readable timestamp, YYYYmmddTHHMMSSsssZ in UTC followed by the 16 character
+ * entropy and a terminating null, 36 characters in all.
+ *
+ * The date is computed arithmetically (see ulid_civil.hh), without the C
+ * library's time functions, so this is thread-safe.
+ * */
+template <class ULID>
+inline void MarshalToHuman(const ULID& ulid, char dst[36]) {
+    civil::EncodeTimestamp(Time(ulid), dst);
+
+    // the last 16 characters of the Base32 encoding are the 80 bits of entropy
+    char data[26];
+    MarshalTo(ulid, data);
+    std::memcpy(dst + 19, data + 10, 16);
+    dst[35] = 0;
+}
+
+/**
+ * MarshalHuman will marshal a ULID to a std::string with human timestamp.
+ * */
+template <class ULID>
+inline std::string MarshalHuman(const ULID& ulid) {
+    char data[36];
+    MarshalToHuman(ulid, data);
+    return std::string(data);
+}
+
+/**
+ * Marshal will marshal a ULID to a std::string.
+ * */
+template <class ULID>
+inline std::string Marshal(const ULID& ulid) {
+    char data[27];
+    data[26] = '\0';
+    MarshalTo(ulid, data);
+    return std::string(data);
+}
+
+/**
+ * MarshalArray will marshal a ULID to a fixed size character array, without
+ * allocating. The array is not null terminated.
+ * */
+template <class ULID>
+inline std::array<char, 26> MarshalArray(const ULID& ulid) {
+    std::array<char, 26> dst;
+    MarshalTo(ulid, dst.data());
+    return dst;
+}
+
+/**
+ * Write writes the 26 character encoding of a ULID to the stream, see operator<<.
+ * */
+template <class ULID>
+inline std::ostream& Write(std::ostream& os, const ULID& ulid) {
+    char data[26];
+    MarshalTo(ulid, data);
+    return os.write(data, 26);
+}
+
+/**
+ * MarshalBinaryTo will Marshal a ULID to the passed byte array
+ * */
+template <class ULID>
+inline void MarshalBinaryTo(const ULID& ulid, uint8_t dst[16]) {
+    Storage<ULID>::ToBytes(ulid, dst);
+}
+
+/**
+ * MarshalBinary will Marshal a ULID to a byte vector.
+ * */
+template <class ULID>
+inline std::vector<uint8_t> MarshalBinary(const ULID& ulid) {
+    std::vector<uint8_t> dst(16);
+    MarshalBinaryTo(ulid, dst.data());
+    return dst;
+}
+
+/**
+ * MarshalBinaryArray will Marshal a ULID to a fixed size byte array, without allocating.
+ * */
+template <class ULID>
+inline std::array<uint8_t, 16> MarshalBinaryArray(const ULID& ulid) {
+    std::array<uint8_t, 16> dst;
+    MarshalBinaryTo(ulid, dst.data());
+    return dst;
+}
+
+/**
+ * UnmarshalFrom will unmarshal a ULID from the passed character array.
+ *
+ * The 5 bit values are shifted straight into the two words, the inverse of
+ * MarshalToScalar.
+ * */
+template <class ULID>
+inline constexpr void UnmarshalFrom(const char str[26], ULID& ulid) {
+    uint64_t hi = dec[static_cast<uint8_t>(str[0])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[1])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[2])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[3])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[4])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[5])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[6])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[7])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[8])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[9])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[10])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[11])];
+    hi = (hi << 5) | dec[static_cast<uint8_t>(str[12])];
+
+    const uint64_t split = dec[static_cast<uint8_t>(str[13])];
+    hi = (hi << 1) | (split >> 4);
+
+    uint64_t lo = split & 15;
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[14])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[15])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[16])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[17])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[18])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[19])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[20])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[21])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[22])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[23])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[24])];
+    lo = (lo << 5) | dec[static_cast<uint8_t>(str[25])];
+
+    Storage<ULID>::Set(ulid, hi, lo);
+}
+
+/**
+ * Unmarshal will create a new ULID by unmarshaling the passed string, which
+ * must be at least 26 characters.
+ * */
+template <class ULID>
+inline ULID Unmarshal(std::string_view str) {
+    ULID ulid{};
+    UnmarshalFrom(str.data(), ulid);
+    return ulid;
+}
+
+/**
+ * UnmarshalHumanFrom will unmarshal a ULID from the passed character array with
+ * human readable timestamp, see MarshalToHuman.
+ *
+ * Like UnmarshalFrom, the input is not validated.
+ * */
+template <class ULID>
+inline void UnmarshalHumanFrom(const char str[36], ULID& ulid) {
+    char data[26];
+    std::memset(data, '0', 10);
+    std::memcpy(data + 10, str + 19, 16);
+    UnmarshalFrom(data, ulid);
+
+    EncodeTime(civil::DecodeTimestamp(str), ulid);
+}
+
+/**
+ * UnmarshalHuman will create a new ULID by unmarshaling the passed string with human timestamp.
+ * */
+template <class ULID>
+inline ULID UnmarshalHuman(const std::string& str) {
+    ULID ulid{};
+    UnmarshalHumanFrom(str.c_str(), ulid);
+    return ulid;
+}
+
+/**
+ * TryUnmarshalFrom will validate and unmarshal the passed character array.
+ *
+ * Unlike UnmarshalFrom it accepts lowercase letters and Crockford's aliases
+ * (I and L for 1, O for 0), rejects anything else outside the alphabet and a
+ * first character above '7'. On failure the ULID is left untouched.
+ * */
+template <class ULID>
+inline Status TryUnmarshalFrom(const char str[26], ULID& ulid) {
+    return base32::Decode<Storage<ULID>::LittleEndian>(str, &ulid);
+}
+
+/**
+ * TryUnmarshal will validate and unmarshal the passed string, which must be 26 characters.
+ * */
+template <class ULID>
+inline Status TryUnmarshal(std::string_view str, ULID& ulid) {
+    if (str.size() != 26) {
+        return Status::InvalidLength;
+    }
+    return TryUnmarshalFrom(str.data(), ulid);
+}
+
+/**
+ * Literal decodes a ULID literal, see ValidLiteral. Reaching InvalidLiteral
+ * during constant evaluation fails the compilation.
+ * */
+template <class ULID>
+inline constexpr ULID Literal(const char* str, size_t len) {
+    if (!ValidLiteral(str, len)) {
+        InvalidLiteral();
+    }
+    ULID ulid{};
+    UnmarshalFrom(str, ulid);
+    return ulid;
+}
+
+/**
+ * TryUnmarshalBatch will validate and unmarshal n ULIDs, the i-th read from
+ * src + i * stride, into out.
+ *
+ * Returns the number of ULIDs unmarshaled, less than n when the string at that
+ * index failed to validate.
+ * */
+template <class ULID>
+inline size_t TryUnmarshalBatch(const char* src, size_t n, size_t stride, ULID* out) {
+    return base32::DecodeBatch<Storage<ULID>::LittleEndian>(src, n, stride, out);
+}
+
+/**
+ * TryUnmarshalLines will validate and unmarshal up to n newline terminated ULIDs
+ * from [src, src + len) into out.
+ *
+ * Returns the number of ULIDs unmarshaled and sets *consumed to the bytes read,
+ * so src + *consumed is the first line that was not unmarshaled.
+ * */
+template <class ULID>
+inline size_t TryUnmarshalLines(const char* src, size_t len, ULID* out, size_t n, size_t* consumed) {
+    return base32::DecodeLines<Storage<ULID>::LittleEndian>(src, len, n, out, consumed);
+}
+
+/**
+ * UnmarshalBinaryFrom will unmarshal a ULID from the passed byte array.
+ * */
+template <class ULID>
+inline void UnmarshalBinaryFrom(const uint8_t b[16], ULID& ulid) {
+    Storage<ULID>::FromBytes(b, ulid);
+}
+
+/**
+ * Unmarshal will create a new ULID by unmarshaling the passed byte vector.
+ * */
+template <class ULID>
+inline ULID UnmarshalBinary(const std::vector<uint8_t>& b) {
+    ULID ulid{};
+    UnmarshalBinaryFrom(b.data(), ulid);
+    return ulid;
+}
+
+/**
+ * UnmarshalBinary will create a new ULID from the passed 16 bytes. Also takes
+ * a braced list of 16 bytes without building a vector.
+ * */
+template <class ULID>
+inline ULID UnmarshalBinary(const uint8_t (&b)[16]) {
+    ULID ulid{};
+    UnmarshalBinaryFrom(b, ulid);
+    return ulid;
+}
+
+template <class ULID>
+inline ULID UnmarshalBinary(const std::array<uint8_t, 16>& b) {
+    ULID ulid{};
+    UnmarshalBinaryFrom(b.data(), ulid);
+    return ulid;
+}
+
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L
+template <class ULID>
+inline ULID UnmarshalBinary(std::span<const uint8_t, 16> b) {
+    ULID ulid{};
+    UnmarshalBinaryFrom(b.data(), ulid);
+    return ulid;
+}
+#endif
+
+/**
+ * CompareULIDs will compare two ULIDs.
+ * returns:
+ *     -1 if ulid1 is Lexicographically before ulid2
+ *      1 if ulid1 is Lexicographically after ulid2
+ *      0 if ulid1 is same as ulid2
+ *
+ * The ULIDs are compared as two 64 bit words without branches, the low word
+ * only decides when the high words are equal.
+ * */
+template <class ULID>
+inline int CompareULIDs(const ULID& ulid1, const ULID& ulid2) {
+    uint64_t hi1 = Storage<ULID>::Hi(ulid1), hi2 = Storage<ULID>::Hi(ulid2);
+    uint64_t lo1 = Storage<ULID>::Lo(ulid1), lo2 = Storage<ULID>::Lo(ulid2);
+
+    int hi = (hi1 > hi2) - (hi1 < hi2);
+    int lo = (lo1 > lo2) - (lo1 < lo2);
+    return hi + (hi == 0) * lo;
+}
+
+template <class ULID>
+inline bool Less(const ULID& ulid1, const ULID& ulid2) {
+    uint64_t hi1 = Storage<ULID>::Hi(ulid1), hi2 = Storage<ULID>::Hi(ulid2);
+    uint64_t lo1 = Storage<ULID>::Lo(ulid1), lo2 = Storage<ULID>::Lo(ulid2);
+
+    return (hi1 < hi2) | ((hi1 == hi2) & (lo1 < lo2));
+}
+
+template <class ULID>
+inline bool Equal(const ULID& ulid1, const ULID& ulid2) {
+    uint64_t hi = Storage<ULID>::Hi(ulid1) ^ Storage<ULID>::Hi(ulid2);
+    uint64_t lo = Storage<ULID>::Lo(ulid1) ^ Storage<ULID>::Lo(ulid2);
+    return (hi | lo) == 0;
+}
+
+/**
+ * Operators gives a class type ULID its comparison and stream operators as
+ * hidden friends, found through argument dependent lookup wherever the ULID
+ * is used. Representations derive from Operators<Self>.
+ * */
+template <class ULID>
+struct Operators {
+    friend bool operator==(const ULID& ulid1, const ULID& ulid2) {
+        return Equal(ulid1, ulid2);
+    }
+
+    friend bool operator!=(const ULID& ulid1, const ULID& ulid2) {
+        return !Equal(ulid1, ulid2);
+    }
+
+    friend bool operator<(const ULID& ulid1, const ULID& ulid2) {
+        return Less(ulid1, ulid2);
+    }
+
+    friend bool operator>(const ULID& ulid1, const ULID& ulid2) {
+        return Less(ulid2, ulid1);
+    }
+
+    friend bool operator<=(const ULID& ulid1, const ULID& ulid2) {
+        return !Less(ulid2, ulid1);
+    }
+
+    friend bool operator>=(const ULID& ulid1, const ULID& ulid2) {
+        return !Less(ulid1, ulid2);
+    }
+
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L
+    friend std::strong_ordering operator<=>(const ULID& ulid1, const ULID& ulid2) {
+        return CompareULIDs(ulid1, ulid2) <=> 0;
+    }
+#endif
+
+    friend std::ostream& operator<<(std::ostream& os, const ULID& ulid) {
+        return Write(os, ulid);
+    }
+};
+
+/**
+ * Formatter writes the 26 character encoding straight to the output of
+ * std::format or fmt::format, see the formatter specializations of the
+ * representations.
+ * */
+template <class ULID>
+struct Formatter {
+    template <class ParseContext>
+    constexpr typename ParseContext::iterator parse(ParseContext& ctx) {
+        return ctx.begin();
+    }
+
+    template <class FormatContext>
+    typename FormatContext::iterator format(const ULID& ulid, FormatContext& ctx) const {
+        char data[26];
+        MarshalTo(ulid, data);
+        return std::copy(data, data + 26, ctx.out());
+    }
+};
+
+/**
+ * HashWords mixes the two words of a ULID into 64 bits. The entropy is already
+ * random, so one multiply is enough to spread it, and the timestamp, folded in
+ * with another, still separates ULIDs with little or no entropy (MinULID, or
+ * ULIDs built from integers).
+ * */
+inline constexpr uint64_t HashWords(uint64_t hi, uint64_t lo) {
+    uint64_t x = lo ^ (hi * 0x9E3779B97F4A7C15ull);
+    x ^= x >> 32;
+    x *= 0xD6E8FEB86659FD93ull;
+    x ^= x >> 32;
+    return x;
+}
+
+/**
+ * Hash is the hash function of ULIDs, for std::unordered_set and friends and
+ * the flat tables in ulid_flat.hh. The class type representations specialize
+ * std::hash with it. A __uint128_t ULID is a builtin type, which std::hash
+ * cannot be specialized for, pass ulid::Hash explicitly.
+ * */
+template <class ULID>
+struct Hash {
+    size_t operator()(const ULID& ulid) const noexcept {
+        return static_cast<size_t>(HashWords(Storage<ULID>::Hi(ulid), Storage<ULID>::Lo(ulid)));
+    }
+};
+
+/**
+ * MonotonicGenerator creates ULIDs that sort in creation order, even when
+ * many of them are created within the same millisecond.
+ *
+ * If the timestamp has not moved past the one in the last ULID handed out
+ * (including when the clock steps backwards), the next ULID reuses that
+ * timestamp and increments the 80 bit entropy by one. Fresh random entropy
+ * is only drawn when the millisecond changes.
+ *
+ * When the entropy of a millisecond is exhausted, Next reports the overflow by
+ * returning false and leaves the passed ULID untouched.
+ *
+ * Where the compiler has a 128 bit compare and swap (ULID_HAS_CAS128) the last
+ * ULID is a single 16 byte word updated with it, so one generator can be shared
+ * by many threads without a lock and every ULID it hands out is unique and
+ * ordered across all of them. Elsewhere each generator keeps the last ULID
+ * in a cache line per thread slot, so Next does not contend up to Shards
+ * threads, and the ordering guarantee holds within a thread only.
+ *
+ * Clock is read by Next(ULID&), see ulid_clock.hh.
+ * */
+template <class ULID, class Clock>
+class BasicMonotonicGenerator {
+public:
+    explicit BasicMonotonicGenerator(Clock clock = Clock()) : clock(clock) {}
+
+    /**
+     * Next creates the next ULID for the current time, read from the clock.
+     * */
+    bool Next(ULID& ulid) {
+        return Next(clock.Now(), ulid);
+    }
+
+    /**
+     * Next creates the next ULID for the passed timestamp, drawing fresh
+     * entropy from the calling thread's DefaultGenerator.
+     * */
+    bool Next(time_t timestamp, ULID& ulid) {
+        return next(timestamp, [](ULID& u) { EncodeEntropyMt19937(u); }, ulid);
+    }
+
+    /**
+     * Next creates the next ULID for the passed timestamp, drawing fresh
+     * entropy from the passed random number generator.
+     * */
+    bool Next(time_t timestamp, const std::function<uint8_t()>& rng, ULID& ulid) {
+        return next(timestamp, [&rng](ULID& u) { EncodeEntropy(rng, u); }, ulid);
+    }
+
+    /**
+     * Next creates the next ULID for the passed timestamp, drawing fresh
+     * entropy from rng without the std::function indirection, see
+     * EncodeEntropy.
+     * */
+    template <class Rng>
+    bool Next(time_t timestamp, Rng&& rng, ULID& ulid) {
+        return next(timestamp, [&rng](ULID& u) { EncodeEntropy(rng, u); }, ulid);
+    }
+
+private:
+    // Increment adds one to the 80 bit entropy, false when it is all ones.
+    static bool Increment(uint64_t& hi, uint64_t& lo) {
+        if ((hi & 0xFFFF) == 0xFFFF && lo == ~uint64_t(0)) {
+            return false;
+        }
+
+        lo++;
+        hi += lo == 0;
+        return true;
+    }
+
+    static bool Increment(ULID& ulid) {
+        uint64_t hi = Storage<ULID>::Hi(ulid), lo = Storage<ULID>::Lo(ulid);
+        if (!Increment(hi, lo)) {
+            return false;
+        }
+        Storage<ULID>::Set(ulid, hi, lo);
+        return true;
+    }
+
+#if defined(ULID_HAS_CAS128)
+    // the last ULID is kept as its two words, (hi << 64) | lo, so the loop
+    // works on integers whatever the representation, and the ULID is only
+    // built once, for the ULID handed out.
+    template <class Fill>
+    bool next(time_t timestamp, Fill fill, ULID& ulid) {
+        const uint64_t time = static_cast<uint64_t>(timestamp) & 0xFFFFFFFFFFFF;
+        uint64_t fresh_hi = 0, fresh_lo = 0;
+        bool filled = false;
+
+        __uint128_t expected = load();
+        for (;;) {
+            uint64_t hi = static_cast<uint64_t>(expected >> 64), lo = static_cast<uint64_t>(expected);
+            if (time > hi >> 16) {
+                if (!filled) {
+                    ULID fresh{};
+                    EncodeTime(timestamp, fresh);
+                    fill(fresh);
+                    fresh_hi = Storage<ULID>::Hi(fresh);
+                    fresh_lo = Storage<ULID>::Lo(fresh);
+                    filled = true;
+                }
+                hi = fresh_hi;
+                lo = fresh_lo;
+            } else if (!Increment(hi, lo)) {
+                return false;
+            }
+
+            if (compare_and_swap(expected, (__uint128_t(hi) << 64) | lo)) {
+                Storage<ULID>::Set(ulid, hi, lo);
+                return true;
+            }
+        }
+    }
+
+    // load is only the first guess for compare_and_swap, which checks it, so
+    // the two halves are read with plain loads rather than a locked cmpxchg16b
+    // that would take the cache line exclusively. A torn read just fails the
+    // first compare_and_swap.
+    __uint128_t load() const {
+        typedef uint64_t __attribute__((may_alias)) Word;
+        const Word* words = reinterpret_cast<const Word*>(&last);
+        const uint64_t halves[2] = {
+            __atomic_load_n(words, __ATOMIC_RELAXED),
+            __atomic_load_n(words + 1, __ATOMIC_RELAXED),
+        };
+        __uint128_t bits;
+        std::memcpy(&bits, halves, 16);
+        return bits;
+    }
+
+    // on failure, expected is updated to the current value.
+    ULID_CAS128_TARGET bool compare_and_swap(__uint128_t& expected, __uint128_t desired) {
+        const __uint128_t prev = __sync_val_compare_and_swap(&last, expected, desired);
+        const bool swapped = prev == expected;
+        expected = prev;
+        return swapped;
+    }
+
+    alignas(16) __uint128_t last = 0;
+#else
+public:
+    /**
+     * Shards is the number of thread slots of a generator. Threads beyond it
+     * share a slot, and take turns on it.
+     * */
+    static constexpr size_t Shards = 16;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<bool> busy{false};
+        ULID last{};
+    };
+
+    // ThreadSlot numbers the threads in the order they first call Next.
+    static size_t ThreadSlot() {
+        static std::atomic<size_t> threads{0};
+        static thread_local size_t slot = threads.fetch_add(1, std::memory_order_relaxed);
+        return slot;
+    }
+
+    template <class Fill>
+    bool next(time_t timestamp, Fill fill, ULID& ulid) {
+        Shard& shard = shards[ThreadSlot() % Shards];
+        while (shard.busy.exchange(true, std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+
+        ULID fresh{};
+        EncodeTime(timestamp, fresh);
+        bool ok = true;
+        if (Time(fresh) > Time(shard.last)) {
+            fill(fresh);
+            shard.last = fresh;
+        } else {
+            ok = Increment(shard.last);
+        }
+        if (ok) {
+            ulid = shard.last;
+        }
+
+        shard.busy.store(false, std::memory_order_release);
+        return ok;
+    }
+
+    Shard shards[Shards];
+#endif
+
+    Clock clock;
+};
+
+/**
+ * MonotonicGenerator is a BasicMonotonicGenerator reading clocks::DefaultClock.
+ * */
+template <class ULID>
+using MonotonicGenerator = BasicMonotonicGenerator<ULID, clocks::DefaultClock>;
+
+};  // namespace core
+
+/**
+ * operator<< writes the 26 character encoding of a ULID to the stream.
+ *
+ * Class type ULIDs find theirs through argument dependent lookup (see
+ * core::Operators). A __uint128_t ULID is a builtin type and does not, bring
+ * this one in with using ulid::operator<<.
+ * */
+template <class ULID, typename std::enable_if<IsULID<ULID>::value, int>::type = 0>
+inline std::ostream& operator<<(std::ostream& os, const ULID& ulid) {
+    return core::Write(os, ulid);
+}
+
+};  // namespace ulid
+
+#endif // ULID_CORE_HH
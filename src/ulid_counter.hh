@@ -0,0 +1,270 @@
+#ifndef ULID_COUNTER_HH
+#define ULID_COUNTER_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+
+#include "ulid_core.hh"
+
+namespace ulid {
+
+namespace counter {
+
+/**
+ * Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3")
+ * turns a 128 bit counter and a 64 bit key into 128 random bits with ten rounds
+ * of two 32x32 bit multiplies. Every output is a pure function of its counter
+ * and key, so any one of them can be computed on its own, in any order.
+ * */
+inline constexpr uint32_t M0 = 0xD2511F53;
+inline constexpr uint32_t M1 = 0xCD9E8D57;
+inline constexpr uint32_t W0 = 0x9E3779B9;
+inline constexpr uint32_t W1 = 0xBB67AE85;
+
+/**
+ * Block is the number of ULIDs FillAt computes at a time, on the stack.
+ * */
+inline constexpr size_t Block = 256;
+
+/**
+ * Philox4x32 runs the ten rounds over ctr in place, with key.
+ * */
+inline constexpr void Philox4x32(uint32_t ctr[4], uint64_t key) {
+    uint32_t k0 = static_cast<uint32_t>(key), k1 = static_cast<uint32_t>(key >> 32);
+    for (int round = 0 ; round < 10 ; round++) {
+        const uint64_t p0 = uint64_t(M0) * ctr[0], p1 = uint64_t(M1) * ctr[2];
+        const uint32_t x0 = static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ k0;
+        const uint32_t x1 = static_cast<uint32_t>(p1);
+        const uint32_t x2 = static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ k1;
+        const uint32_t x3 = static_cast<uint32_t>(p0);
+        ctr[0] = x0;
+        ctr[1] = x1;
+        ctr[2] = x2;
+        ctr[3] = x3;
+        k0 += W0;
+        k1 += W1;
+    }
+}
+
+/**
+ * Entropy is the 80 bits of entropy of ULID index of stream, under seed: the
+ * counter is (index, stream), low words first, and the first 80 bits of the
+ * output are kept, the top 16 in hi and the bottom 64 in lo.
+ * */
+inline constexpr void Entropy(uint64_t seed, uint64_t stream, uint64_t index, uint16_t& hi, uint64_t& lo) {
+    uint32_t ctr[4] = {
+        static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32),
+        static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32),
+    };
+    Philox4x32(ctr, seed);
+    lo = (uint64_t(ctr[1]) << 32) | ctr[0];
+    hi = static_cast<uint16_t>(ctr[2]);
+}
+
+#ifdef ULID_BASE32_SIMD
+
+/**
+ * MulHiLoAVX2 multiplies the eight 32 bit lanes of x by m, into the high and low
+ * halves of the 64 bit products. mul_epu32 only reads the even lanes, so the odd
+ * ones are shifted down for a second multiply and the halves blended back.
+ * */
+ULID_TARGET_AVX2 inline void MulHiLoAVX2(__m256i x, __m256i m, __m256i& hi, __m256i& lo) {
+    const __m256i even = _mm256_mul_epu32(x, m);
+    const __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), m);
+    lo = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(even, 32), odd, 0xAA);
+}
+
+/**
+ * EntropyAVX2 computes the entropy of ULIDs [index, index + n) of stream, eight
+ * counters per iteration, one per 32 bit lane, and returns how many it did (n
+ * rounded down to a multiple of eight).
+ * */
+ULID_TARGET_AVX2 inline size_t EntropyAVX2(uint64_t seed, uint64_t stream, uint64_t index, size_t n,
+                                           uint16_t* hi, uint64_t* lo) {
+    const __m256i m0 = _mm256_set1_epi32(static_cast<int>(M0)), m1 = _mm256_set1_epi32(static_cast<int>(M1));
+    const __m256i s0 = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(stream)));
+    const __m256i s1 = _mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(stream >> 32)));
+
+    size_t i = 0;
+    for ( ; i + 8 <= n ; i += 8) {
+        alignas(32) uint32_t c0[8], c1[8];
+        for (int j = 0 ; j < 8 ; j++) {
+            const uint64_t c = index + i + j;
+            c0[j] = static_cast<uint32_t>(c);
+            c1[j] = static_cast<uint32_t>(c >> 32);
+        }
+
+        __m256i x0 = _mm256_load_si256(reinterpret_cast<const __m256i*>(c0));
+        __m256i x1 = _mm256_load_si256(reinterpret_cast<const __m256i*>(c1));
+        __m256i x2 = s0, x3 = s1;
+        uint32_t k0 = static_cast<uint32_t>(seed), k1 = static_cast<uint32_t>(seed >> 32);
+        for (int round = 0 ; round < 10 ; round++) {
+            __m256i hi0, lo0, hi1, lo1;
+            MulHiLoAVX2(x0, m0, hi0, lo0);
+            MulHiLoAVX2(x2, m1, hi1, lo1);
+            x0 = _mm256_xor_si256(_mm256_xor_si256(hi1, x1), _mm256_set1_epi32(static_cast<int>(k0)));
+            x1 = lo1;
+            x2 = _mm256_xor_si256(_mm256_xor_si256(hi0, x3), _mm256_set1_epi32(static_cast<int>(k1)));
+            x3 = lo0;
+            k0 += W0;
+            k1 += W1;
+        }
+
+        // ctr[1]:ctr[0] interleaved into 64 bit words, lanes 0 1 4 5 and 2 3 6 7
+        const __m256i a = _mm256_unpacklo_epi32(x0, x1), b = _mm256_unpackhi_epi32(x0, x1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo + i), _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(lo + i + 4), _mm256_permute2x128_si256(a, b, 0x31));
+
+        alignas(32) uint32_t c2[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(c2), x2);
+        for (int j = 0 ; j < 8 ; j++) {
+            hi[i + j] = static_cast<uint16_t>(c2[j]);
+        }
+    }
+    return i;
+}
+
+#endif // ULID_BASE32_SIMD
+
+/**
+ * EntropyBatch computes the entropy of ULIDs [index, index + n) of stream, the
+ * same values as Entropy, with the AVX2 kernel where the machine has it.
+ * */
+inline void EntropyBatch(uint64_t seed, uint64_t stream, uint64_t index, size_t n, uint16_t* hi, uint64_t* lo) {
+    size_t i = 0;
+#ifdef ULID_BASE32_SIMD
+    if (base32::SimdLevel() >= base32::LevelAVX2) {
+        i = EntropyAVX2(seed, stream, index, n, hi, lo);
+    }
+#endif // ULID_BASE32_SIMD
+    for ( ; i < n ; i++) {
+        Entropy(seed, stream, index + i, hi[i], lo[i]);
+    }
+}
+
+};  // namespace counter
+
+namespace core {
+
+/**
+ * CounterGenerator creates reproducible ULIDs for load tests and simulations:
+ * ULID index of stream is a pure function of (seed, stream, index), its entropy
+ * Philox4x32-10 of the counter (index, stream) under the key seed, and its
+ * timestamp start + index / per_ms.
+ *
+ * So any split of [0, n) between threads, each with its own generator or
+ * calling FillAt on a shared one, produces the same ULIDs, and jumping to any
+ * index (Seek, Discard) is O(1). Streams give independent sequences, e.g. one
+ * per test scenario, all from one seed.
+ *
+ * These ULIDs are predictable from the seed, they are for tests, not for
+ * identifiers that must not be guessed.
+ *
+ * At and FillAt are const and can be called from any number of threads. Next,
+ * Fill, Seek and Discard move the generator's own position, like the standard
+ * engines, and need a generator per thread.
+ * */
+template <class ULID>
+class CounterGenerator {
+public:
+    explicit CounterGenerator(uint64_t seed, uint64_t stream = 0, time_t start = 0, uint64_t per_ms = 1)
+        : seed(seed), stream(stream), start(start), per_ms(per_ms == 0 ? 1 : per_ms) {}
+
+    /**
+     * At creates ULID index.
+     * */
+    void At(uint64_t index, ULID& ulid) const {
+        uint16_t hi;
+        uint64_t lo;
+        counter::Entropy(seed, stream, index, hi, lo);
+        Storage<ULID>::Set(ulid, (static_cast<uint64_t>(Timestamp(index)) << 16) | hi, lo);
+    }
+
+    /**
+     * FillAt creates ULIDs [index, index + n) into out.
+     * */
+    void FillAt(uint64_t index, ULID* out, size_t n) const {
+        uint16_t hi[counter::Block];
+        uint64_t lo[counter::Block];
+
+        // the timestamp is carried along rather than divided out per ULID
+        uint64_t t = static_cast<uint64_t>(Timestamp(index)), into = index % per_ms;
+        while (n > 0) {
+            const size_t count = n < counter::Block ? n : counter::Block;
+            counter::EntropyBatch(seed, stream, index, count, hi, lo);
+            for (size_t i = 0 ; i < count ; i++) {
+                Storage<ULID>::Set(out[i], (t << 16) | hi[i], lo[i]);
+                if (++into == per_ms) {
+                    into = 0;
+                    t++;
+                }
+            }
+            index += count;
+            out += count;
+            n -= count;
+        }
+    }
+
+    /**
+     * Next creates the ULID at the position and moves past it.
+     * */
+    void Next(ULID& ulid) {
+        At(position++, ulid);
+    }
+
+    /**
+     * Fill creates n ULIDs from the position and moves past them.
+     * */
+    void Fill(ULID* out, size_t n) {
+        FillAt(position, out, n);
+        position += n;
+    }
+
+    /**
+     * Seek moves the position to index.
+     * */
+    void Seek(uint64_t index) {
+        position = index;
+    }
+
+    /**
+     * Discard skips n ULIDs.
+     * */
+    void Discard(uint64_t n) {
+        position += n;
+    }
+
+    uint64_t Position() const {
+        return position;
+    }
+
+    uint64_t Seed() const {
+        return seed;
+    }
+
+    uint64_t Stream() const {
+        return stream;
+    }
+
+    /**
+     * Timestamp is the timestamp of ULID index.
+     * */
+    time_t Timestamp(uint64_t index) const {
+        return start + static_cast<time_t>(index / per_ms);
+    }
+
+private:
+    uint64_t seed;
+    uint64_t stream;
+    time_t start;
+    uint64_t per_ms;
+    uint64_t position = 0;
+};
+
+};  // namespace core
+
+};  // namespace ulid
+
+#endif // ULID_COUNTER_HH
@@ -0,0 +1,193 @@
+#ifndef ULID_DEDUP_HH
+#define ULID_DEDUP_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ulid_core.hh"
+#include "ulid_flat.hh"
+
+namespace ulid {
+
+namespace core {
+
+/**
+ * WindowedDeduper tells apart the ULIDs of a stream seen for the first time
+ * from the ones replayed, for ULIDs created within a sliding window of time.
+ *
+ * The window is split into buckets of bucket_ms (by default a sixteenth of
+ * window_ms), each with its own UlidFlatSet. A ULID only ever needs to be
+ * looked for in the bucket of its own timestamp, since a replay carries the
+ * same one, so an insert is one hash probe. The window follows the newest
+ * timestamp seen: when it moves into a new bucket the buckets that fall out
+ * of the window are dropped whole, cleared for reuse, so memory is bounded by
+ * the number of ULIDs created per window rather than growing with the stream.
+ *
+ * A ULID created before the window, whose bucket has been dropped, can no
+ * longer be checked. insert_if_absent reports it as not fresh and counts it
+ * in Late. ULIDs are checked for between window_ms and window_ms + bucket_ms
+ * after their timestamp, depending on where in its bucket they fall.
+ *
+ * The window is moved by the timestamps of the ULIDs themselves, so a ULID
+ * from far in the future (a skewed clock) drops every bucket. Advance moves
+ * it explicitly, e.g. from the wall clock during quiet periods.
+ *
+ * Not thread safe, shard the stream by Hash to dedupe on several threads.
+ * */
+template <class ULID>
+class WindowedDeduper {
+public:
+    explicit WindowedDeduper(int64_t window_ms, int64_t bucket_ms = 0)
+        : bucket_ms(bucket_ms > 0 ? bucket_ms : window_ms / 16 > 0 ? window_ms / 16 : 1),
+          buckets(static_cast<size_t>(window_ms > this->bucket_ms ?
+                                      (window_ms + this->bucket_ms - 1) / this->bucket_ms : 1)),
+          segments(buckets) {}
+
+    /**
+     * insert_if_absent adds a ULID, and returns whether it is fresh: neither
+     * seen within the window nor created before it.
+     * */
+    bool insert_if_absent(const ULID& ulid) {
+        const int64_t bucket = static_cast<int64_t>(Time(ulid)) / bucket_ms;
+        if (bucket > newest) {
+            Slide(bucket);
+        } else if (newest - bucket >= static_cast<int64_t>(buckets)) {
+            late++;
+            return false;
+        }
+
+        if (!segments[static_cast<size_t>(bucket) % buckets].insert(ulid).second) {
+            return false;
+        }
+        n++;
+        return true;
+    }
+
+    /**
+     * insert_if_absent adds n ULIDs in order, sets fresh[i] to whether the
+     * i-th was fresh (fresh can be null) and returns how many were. The
+     * slots of the ULIDs a few ahead are prefetched, so the cache misses of
+     * the lookups overlap.
+     * */
+    size_t insert_if_absent(const ULID* ulids, size_t count, bool* fresh) {
+        const size_t ahead = 8;
+        for (size_t i = 0 ; i < ahead && i < count ; i++) {
+            Prefetch(ulids[i]);
+        }
+
+        size_t added = 0;
+        for (size_t i = 0 ; i < count ; i++) {
+            if (i + ahead < count) {
+                Prefetch(ulids[i + ahead]);
+            }
+            const bool f = insert_if_absent(ulids[i]);
+            if (fresh != nullptr) {
+                fresh[i] = f;
+            }
+            added += f ? 1 : 0;
+        }
+        return added;
+    }
+
+    /**
+     * contains tells whether a ULID has been seen within the window.
+     * */
+    bool contains(const ULID& ulid) const {
+        const int64_t bucket = static_cast<int64_t>(Time(ulid)) / bucket_ms;
+        if (bucket > newest || newest - bucket >= static_cast<int64_t>(buckets)) {
+            return false;
+        }
+        return segments[static_cast<size_t>(bucket) % buckets].contains(ulid);
+    }
+
+    /**
+     * Advance moves the window up to now_ms, as if a ULID created then had
+     * been inserted. It never moves the window back.
+     * */
+    void Advance(int64_t now_ms) {
+        const int64_t bucket = now_ms / bucket_ms;
+        if (bucket > newest) {
+            Slide(bucket);
+        }
+    }
+
+    /**
+     * WindowStart is the earliest timestamp still checked, 0 before the first
+     * ULID.
+     * */
+    int64_t WindowStart() const {
+        const int64_t first = newest - static_cast<int64_t>(buckets) + 1;
+        return first > 0 ? first * bucket_ms : 0;
+    }
+
+    /**
+     * size is the number of ULIDs held, the fresh ones inserted within the window.
+     * */
+    size_t size() const {
+        return n;
+    }
+
+    /**
+     * Late is the number of ULIDs rejected for being created before the window.
+     * */
+    uint64_t Late() const {
+        return late;
+    }
+
+    /**
+     * AllocatedBytes is the memory held by the buckets. Dropped buckets keep
+     * theirs for the ones that replace them, so under a steady rate it stays
+     * flat once the window has filled.
+     * */
+    size_t AllocatedBytes() const {
+        size_t bytes = segments.capacity() * sizeof(UlidFlatSet<ULID>);
+        for (const auto& segment : segments) {
+            bytes += segment.AllocatedBytes();
+        }
+        return bytes;
+    }
+
+    int64_t BucketMs() const {
+        return bucket_ms;
+    }
+
+    size_t Buckets() const {
+        return buckets;
+    }
+
+private:
+    // Slide makes bucket the newest, dropping the buckets that fall out of
+    // the window: those in (newest, bucket], modulo the ring, whose slots
+    // they take over.
+    void Slide(int64_t bucket) {
+        const int64_t from = bucket - newest > static_cast<int64_t>(buckets) ?
+                             bucket - static_cast<int64_t>(buckets) + 1 : newest + 1;
+        for (int64_t b = from ; b <= bucket ; b++) {
+            auto& segment = segments[static_cast<size_t>(b) % buckets];
+            n -= segment.size();
+            segment.clear();
+        }
+        newest = bucket;
+    }
+
+    void Prefetch(const ULID& ulid) const {
+        const int64_t bucket = static_cast<int64_t>(Time(ulid)) / bucket_ms;
+        segments[static_cast<size_t>(bucket) % buckets].Prefetch(ulid);
+    }
+
+    const int64_t bucket_ms;
+    const size_t buckets;
+
+    // the set of bucket b is segments[b % buckets]
+    std::vector<UlidFlatSet<ULID>> segments;
+    int64_t newest = -1;
+    size_t n = 0;
+    uint64_t late = 0;
+};
+
+};  // namespace core
+
+};  // namespace ulid
+
+#endif // ULID_DEDUP_HH
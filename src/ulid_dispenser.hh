@@ -0,0 +1,264 @@
+#ifndef ULID_DISPENSER_HH
+#define ULID_DISPENSER_HH
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "ulid_core.hh"
+
+namespace ulid {
+
+namespace core {
+
+/**
+ * BasicIdDispenser hands out ULIDs minted ahead of time, so a request path pays
+ * for neither the clock read nor the entropy of a new ULID, only for taking one
+ * off a ring: a single compare and swap.
+ *
+ * A background thread keeps the ring topped up. Whenever fewer than half of
+ * high_water ULIDs are left it mints up to high_water more with GenerateBatch,
+ * one clock read and one entropy fill per 256 ULIDs, and then stops. The
+ * consumer that takes the ring below half wakes it.
+ *
+ * Minted ULIDs carry the time they were minted, not the time they are handed
+ * out. The thread also wakes every max_staleness_ms / 4 and throws away the
+ * ULIDs older than max_staleness_ms / 2, so no ULID handed out is more than
+ * max_staleness_ms behind the clock, as long as the thread is scheduled within
+ * a quarter of it. When the ring runs dry Next mints a ULID inline instead.
+ *
+ * The ring is a bounded multi producer multi consumer queue with a sequence
+ * number per slot: a slot is taken by the consumer that moves the shared head
+ * past it, and handed back to the producer by bumping its sequence.
+ *
+ * Next can be called from any number of threads. Clock is read by the
+ * background thread, and by Next when the ring is empty.
+ * */
+template <class ULID, class Clock>
+class BasicIdDispenser {
+public:
+    explicit BasicIdDispenser(size_t high_water = 1 << 16, int64_t max_staleness_ms = 100, Clock clock = Clock())
+        : high_water(high_water < 2 ? 2 : high_water),
+          max_staleness_ms(max_staleness_ms < 4 ? 4 : max_staleness_ms),
+          clock(clock) {
+        size_t capacity = 1;
+        while (capacity < this->high_water) {
+            capacity *= 2;
+        }
+        mask = capacity - 1;
+
+        slots.reset(new Slot[capacity]);
+        for (size_t i = 0 ; i < capacity ; i++) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        worker = std::thread([this] { Refill(); });
+    }
+
+    BasicIdDispenser(const BasicIdDispenser&) = delete;
+    BasicIdDispenser& operator=(const BasicIdDispenser&) = delete;
+
+    ~BasicIdDispenser() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    /**
+     * Next takes a minted ULID, or mints one inline when there are none left.
+     * */
+    void Next(ULID& ulid) {
+        if (!TryNext(ulid)) {
+            GenerateBatch(clock, DefaultGenerator(), &ulid, 1);
+        }
+    }
+
+    ULID Next() {
+        ULID ulid{};
+        Next(ulid);
+        return ulid;
+    }
+
+    /**
+     * TryNext takes a minted ULID, false when there are none left.
+     * */
+    bool TryNext(ULID& ulid) {
+        size_t position;
+        if (!Pop(ulid, position)) {
+            Wake();
+            return false;
+        }
+        if (position == low_water_at.load(std::memory_order_relaxed)) {
+            Wake();
+        }
+        return true;
+    }
+
+    /**
+     * Available is the number of minted ULIDs left, racy while others take them.
+     * */
+    size_t Available() const {
+        const size_t t = tail.load(std::memory_order_acquire), h = head.load(std::memory_order_acquire);
+        return t > h ? t - h : 0;
+    }
+
+    size_t HighWater() const {
+        return high_water;
+    }
+
+private:
+    struct Slot {
+        std::atomic<size_t> sequence;
+        ULID ulid;
+    };
+
+    // Push is only called by the background thread, the only producer.
+    bool Push(const ULID& ulid) {
+        const size_t position = tail.load(std::memory_order_relaxed);
+        Slot& slot = slots[position & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != position) {
+            return false;
+        }
+        slot.ulid = ulid;
+        slot.sequence.store(position + 1, std::memory_order_release);
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pop takes the ULID at the head, and the position it was at.
+    bool Pop(ULID& ulid, size_t& position) {
+        size_t h = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[h & mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const ptrdiff_t ready = static_cast<ptrdiff_t>(sequence - (h + 1));
+            if (ready == 0) {
+                if (head.compare_exchange_weak(h, h + 1, std::memory_order_relaxed)) {
+                    ulid = slot.ulid;
+                    slot.sequence.store(h + mask + 1, std::memory_order_release);
+                    position = h;
+                    return true;
+                }
+            } else if (ready < 0) {
+                return false;
+            } else {
+                h = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Sweep throws away the ULIDs minted before cutoff, which are the oldest
+    // blocks, by moving the head past them in one step and handing their
+    // slots back.
+    void Sweep(int64_t cutoff) {
+        size_t end = 0;
+        while (!blocks.empty() && blocks.front().second < cutoff) {
+            end = blocks.front().first;
+            blocks.pop_front();
+        }
+
+        size_t h = head.load(std::memory_order_relaxed);
+        while (h < end && !head.compare_exchange_weak(h, end, std::memory_order_relaxed)) {}
+        for ( ; h < end ; h++) {
+            slots[h & mask].sequence.store(h + mask + 1, std::memory_order_release);
+        }
+
+        // blocks already handed out
+        while (!blocks.empty() && blocks.front().first <= h) {
+            blocks.pop_front();
+        }
+    }
+
+    // Wake asks the background thread for a refill. Only the consumer raising
+    // the flag signals, the others would queue on the condition variable.
+    void Wake() {
+        if (!wanted.load(std::memory_order_relaxed) && !wanted.exchange(true)) {
+            wake.notify_one();
+        }
+    }
+
+    void Refill() {
+        const size_t block = 256;
+        ULID minted[block];
+        const auto period = std::chrono::milliseconds(max_staleness_ms / 4);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            lock.unlock();
+
+            Sweep(clock.Now() - max_staleness_ms / 2);
+            if (Available() < high_water / 2) {
+                // at most high_water per round, consumers may be taking them as fast
+                for (size_t total = 0, n = Available() ; total < high_water && n < high_water ; n = Available()) {
+                    const size_t count = std::min(block, high_water - n);
+                    GenerateBatch(clock, DefaultGenerator(), minted, count);
+                    size_t pushed = 0;
+                    while (pushed < count) {
+                        if (Push(minted[pushed])) {
+                            pushed++;
+                        } else if (tail.load(std::memory_order_relaxed) - head.load(std::memory_order_relaxed) > mask) {
+                            break;
+                        } else {
+                            // the slot's consumer has moved the head but not handed it back yet
+                            std::this_thread::yield();
+                        }
+                    }
+                    blocks.emplace_back(tail.load(std::memory_order_relaxed), static_cast<int64_t>(Time(minted[0])));
+                    if (pushed < count) {
+                        break;
+                    }
+                    total += count;
+                }
+                low_water_at.store(tail.load(std::memory_order_relaxed) - high_water / 2, std::memory_order_relaxed);
+            }
+
+            lock.lock();
+            wake.wait_for(lock, period, [this] { return stopping || wanted.exchange(false); });
+        }
+    }
+
+    const size_t high_water;
+    const int64_t max_staleness_ms;
+    Clock clock;
+
+    size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    // consumers share head, the producer owns tail
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    std::atomic<size_t> low_water_at{~size_t(0)};
+
+    // the end position and time of each block minted and not yet handed out,
+    // oldest first, only touched by the background thread
+    std::deque<std::pair<size_t, int64_t>> blocks;
+
+    std::atomic<bool> wanted{false};
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+};
+
+/**
+ * IdDispenser is a BasicIdDispenser reading clocks::DefaultClock.
+ * */
+template <class ULID>
+using IdDispenser = BasicIdDispenser<ULID, clocks::DefaultClock>;
+
+};  // namespace core
+
+};  // namespace ulid
+
+#endif // ULID_DISPENSER_HH
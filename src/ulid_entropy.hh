@@ -0,0 +1,270 @@
+#ifndef ULID_ENTROPY_HH
+#define ULID_ENTROPY_HH
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <unistd.h>
+#if defined(__has_include)
+#if __has_include(<sys/random.h>)
+#include <sys/random.h>
+#define ULID_HAS_GETRANDOM
+#endif
+#endif
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <stdlib.h>
+#endif
+
+namespace ulid {
+namespace entropy {
+
+template <class...>
+struct Void {
+    typedef void type;
+};
+
+/**
+ * HasFill detects random number generators with a bulk fill(uint8_t*, size_t) member.
+ * */
+template <class Rng, class = void>
+struct HasFill : std::false_type {};
+
+template <class Rng>
+struct HasFill<Rng, typename Void<decltype(std::declval<Rng&>().fill(static_cast<uint8_t*>(nullptr), size_t(0)))>::type>
+    : std::true_type {};
+
+/**
+ * WordBits is 64 or 32 for uniform random bit generators whose every draw is a full
+ * 64 or 32 bit word (std::mt19937_64, std::mt19937, ...), and 0 for anything else.
+ * */
+template <class Rng, class = void>
+struct WordBits : std::integral_constant<int, 0> {};
+
+template <class Rng>
+struct WordBits<Rng, typename Void<std::integral_constant<uint64_t, Rng::min()>, std::integral_constant<uint64_t, Rng::max()>>::type>
+    : std::integral_constant<int,
+        Rng::min() != 0 ? 0 :
+        uint64_t(Rng::max()) == ~uint64_t(0) ? 64 :
+        uint64_t(Rng::max()) == 0xFFFFFFFFull ? 32 : 0> {};
+
+/**
+ * Draw is how Draw80 gets 80 bits out of a generator, picked at compile time.
+ * */
+enum Draw {
+    DrawBytes = 0, // ten calls, each returning one byte
+    DrawFill = 1,  // one fill call for all ten bytes
+    DrawWord32 = 32,
+    DrawWord64 = 64,
+};
+
+template <class Rng>
+struct Strategy : std::integral_constant<int,
+    HasFill<typename std::decay<Rng>::type>::value ? DrawFill :
+    WordBits<typename std::decay<Rng>::type>::value != 0 ? WordBits<typename std::decay<Rng>::type>::value : DrawBytes> {};
+
+template <class Rng>
+inline void Draw80(Rng& rng, uint16_t& hi, uint64_t& lo, std::integral_constant<int, DrawBytes>) {
+    // the first byte drawn is the most significant, like EncodeEntropy
+    hi = static_cast<uint8_t>(rng());
+    hi = static_cast<uint16_t>((hi << 8) | static_cast<uint8_t>(rng()));
+
+    lo = static_cast<uint8_t>(rng());
+    for (int i = 0 ; i < 7 ; i++) {
+        lo = (lo << 8) | static_cast<uint8_t>(rng());
+    }
+}
+
+template <class Rng>
+inline void Draw80(Rng& rng, uint16_t& hi, uint64_t& lo, std::integral_constant<int, DrawFill>) {
+    uint8_t b[10];
+    rng.fill(b, 10);
+
+    hi = static_cast<uint16_t>((b[0] << 8) | b[1]);
+    lo = 0;
+    for (int i = 2 ; i < 10 ; i++) {
+        lo = (lo << 8) | b[i];
+    }
+}
+
+template <class Rng>
+inline void Draw80(Rng& rng, uint16_t& hi, uint64_t& lo, std::integral_constant<int, DrawWord32>) {
+    lo = static_cast<uint32_t>(rng());
+    lo = (lo << 32) | static_cast<uint32_t>(rng());
+    hi = static_cast<uint16_t>(rng());
+}
+
+template <class Rng>
+inline void Draw80(Rng& rng, uint16_t& hi, uint64_t& lo, std::integral_constant<int, DrawWord64>) {
+    lo = static_cast<uint64_t>(rng());
+    hi = static_cast<uint16_t>(rng());
+}
+
+/**
+ * Draw80 draws 80 random bits from rng, as the top 16 bits in hi and the bottom 64 in lo.
+ *
+ * Generators with a fill(uint8_t*, size_t) member are asked for all 10 bytes at once,
+ * full range 64 (32) bit generators are called 2 (3) times, and anything else is
+ * called 10 times, keeping the low byte of each result.
+ * */
+template <class Rng>
+inline void Draw80(Rng& rng, uint16_t& hi, uint64_t& lo) {
+    Draw80(rng, hi, lo, std::integral_constant<int, Strategy<Rng>::value>());
+}
+
+template <class Rng>
+inline void Fill(Rng& rng, uint8_t* dst, size_t n, std::integral_constant<int, DrawBytes>) {
+    for (size_t i = 0 ; i < n ; i++) {
+        dst[i] = static_cast<uint8_t>(rng());
+    }
+}
+
+template <class Rng>
+inline void Fill(Rng& rng, uint8_t* dst, size_t n, std::integral_constant<int, DrawFill>) {
+    rng.fill(dst, n);
+}
+
+template <class Rng>
+inline void Fill(Rng& rng, uint8_t* dst, size_t n, std::integral_constant<int, DrawWord32>) {
+    for (size_t i = 0 ; i < n ; i += 4) {
+        uint32_t w = static_cast<uint32_t>(rng());
+        std::memcpy(dst + i, &w, n - i < 4 ? n - i : 4);
+    }
+}
+
+template <class Rng>
+inline void Fill(Rng& rng, uint8_t* dst, size_t n, std::integral_constant<int, DrawWord64>) {
+    for (size_t i = 0 ; i < n ; i += 8) {
+        uint64_t w = static_cast<uint64_t>(rng());
+        std::memcpy(dst + i, &w, n - i < 8 ? n - i : 8);
+    }
+}
+
+/**
+ * Fill fills dst[0, n) with random bytes from rng, using whole words or a single
+ * fill call where the generator allows it, see Draw80.
+ * */
+template <class Rng>
+inline void Fill(Rng& rng, uint8_t* dst, size_t n) {
+    Fill(rng, dst, n, std::integral_constant<int, Strategy<Rng>::value>());
+}
+
+/**
+ * SystemRandom fills dst[0, n) from the operating system's CSPRNG: getrandom(2) on
+ * Linux, arc4random_buf on macOS and the BSDs, std::random_device elsewhere.
+ * */
+inline void SystemRandom(uint8_t* dst, size_t n) {
+#if defined(ULID_HAS_GETRANDOM)
+    while (n > 0) {
+        ssize_t r = getrandom(dst, n, 0);
+        if (r < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        dst += r;
+        n -= static_cast<size_t>(r);
+    }
+    if (n == 0) {
+        return;
+    }
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+    arc4random_buf(dst, n);
+    return;
+#endif
+    // no getrandom (old kernel or libc), random_device reads /dev/urandom or the platform CSPRNG
+    std::random_device device;
+    for (size_t i = 0 ; i < n ; i += 4) {
+        uint32_t w = static_cast<uint32_t>(device());
+        std::memcpy(dst + i, &w, n - i < 4 ? n - i : 4);
+    }
+}
+
+/**
+ * ForkGeneration counts the fork() calls made by this process and its ancestors,
+ * so per thread buffers can tell that they were copied into a child.
+ * */
+inline std::atomic<unsigned>& ForkGeneration() {
+    static std::atomic<unsigned> generation{0};
+    return generation;
+}
+
+inline void OnFork() {
+    ForkGeneration().fetch_add(1, std::memory_order_relaxed);
+}
+
+inline bool WatchFork() {
+#if defined(__unix__) || defined(__APPLE__)
+    return pthread_atfork(nullptr, nullptr, OnFork) == 0;
+#else
+    return true;
+#endif
+}
+
+/**
+ * SecureRandom hands out bytes from the operating system's CSPRNG.
+ *
+ * A system call per ULID is too expensive, so each thread keeps a 4 KB buffer
+ * (about 400 ULIDs worth of entropy), refilled with SystemRandom once used up.
+ * Every byte is handed out once. A fork() handler discards the buffer in the
+ * child, so a parent and its children never hand out the same bytes.
+ *
+ * SecureRandom is stateless, it can be created wherever it is needed and used
+ * with the templated EncodeEntropy, Encode, Create and GenerateBatch.
+ * */
+class SecureRandom {
+public:
+    static const size_t BufferSize = 4096;
+
+    void fill(uint8_t* dst, size_t n) {
+        static const bool watching = WatchFork();
+        (void)watching;
+
+        Pool& pool = ThreadPool();
+        unsigned generation = ForkGeneration().load(std::memory_order_relaxed);
+        if (pool.generation != generation) {
+            pool.generation = generation;
+            pool.pos = BufferSize;
+        }
+
+        while (n > 0) {
+            if (pool.pos == BufferSize) {
+                SystemRandom(pool.buffer, BufferSize);
+                pool.pos = 0;
+            }
+
+            size_t count = BufferSize - pool.pos < n ? BufferSize - pool.pos : n;
+            std::memcpy(dst, pool.buffer + pool.pos, count);
+            pool.pos += count;
+            dst += count;
+            n -= count;
+        }
+    }
+
+private:
+    struct Pool {
+        uint8_t buffer[BufferSize];
+        size_t pos = BufferSize;
+        unsigned generation = 0;
+    };
+
+    static Pool& ThreadPool() {
+        static thread_local Pool pool;
+        return pool;
+    }
+};
+
+};  // namespace entropy
+};  // namespace ulid
+
+#endif // ULID_ENTROPY_HH
@@ -0,0 +1,375 @@
+#ifndef ULID_FILE_HH
+#define ULID_FILE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ULID_HAS_MMAP
+#endif
+
+#include "ulid_core.hh"
+
+namespace ulid {
+
+namespace core {
+
+/**
+ * BinaryIterator walks an array of 16 byte big endian records, the format of
+ * MarshalBinaryTo, decoding each one to a ULID as it is read.
+ *
+ * It is a proxy iterator: * returns a ULID by value, there is no ULID in
+ * memory to refer to. A legacy forward iterator must return a reference, so
+ * its iterator_category is input, while it has all the random access
+ * operations and C++20 sees it as a std::random_access_iterator through
+ * iterator_concept. The std algorithms give correct results with it, but
+ * the pre C++20 ones step it one record at a time: search with
+ * MappedUlidFile::LowerBound and UpperBound, or the std::ranges algorithms.
+ * */
+template <class ULID>
+class BinaryIterator {
+public:
+    typedef std::input_iterator_tag iterator_category;
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L
+    typedef std::random_access_iterator_tag iterator_concept;
+#endif
+    typedef ULID value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef void pointer;
+    typedef ULID reference;
+
+    BinaryIterator() = default;
+
+    explicit BinaryIterator(const uint8_t* p) : p(p) {}
+
+    ULID operator*() const {
+        ULID ulid{};
+        Storage<ULID>::FromBytes(p, ulid);
+        return ulid;
+    }
+
+    ULID operator[](difference_type i) const {
+        return *(*this + i);
+    }
+
+    BinaryIterator& operator++() {
+        p += 16;
+        return *this;
+    }
+
+    BinaryIterator operator++(int) {
+        BinaryIterator it = *this;
+        p += 16;
+        return it;
+    }
+
+    BinaryIterator& operator--() {
+        p -= 16;
+        return *this;
+    }
+
+    BinaryIterator operator--(int) {
+        BinaryIterator it = *this;
+        p -= 16;
+        return it;
+    }
+
+    BinaryIterator& operator+=(difference_type i) {
+        p += 16 * i;
+        return *this;
+    }
+
+    BinaryIterator& operator-=(difference_type i) {
+        p -= 16 * i;
+        return *this;
+    }
+
+    friend BinaryIterator operator+(BinaryIterator it, difference_type i) {
+        return it += i;
+    }
+
+    friend BinaryIterator operator+(difference_type i, BinaryIterator it) {
+        return it += i;
+    }
+
+    friend BinaryIterator operator-(BinaryIterator it, difference_type i) {
+        return it -= i;
+    }
+
+    friend difference_type operator-(const BinaryIterator& a, const BinaryIterator& b) {
+        return (a.p - b.p) / 16;
+    }
+
+    friend bool operator==(const BinaryIterator& a, const BinaryIterator& b) {
+        return a.p == b.p;
+    }
+
+    friend bool operator!=(const BinaryIterator& a, const BinaryIterator& b) {
+        return a.p != b.p;
+    }
+
+    friend bool operator<(const BinaryIterator& a, const BinaryIterator& b) {
+        return a.p < b.p;
+    }
+
+    friend bool operator>(const BinaryIterator& a, const BinaryIterator& b) {
+        return a.p > b.p;
+    }
+
+    friend bool operator<=(const BinaryIterator& a, const BinaryIterator& b) {
+        return a.p <= b.p;
+    }
+
+    friend bool operator>=(const BinaryIterator& a, const BinaryIterator& b) {
+        return a.p >= b.p;
+    }
+
+private:
+    const uint8_t* p = nullptr;
+};
+
+#ifdef ULID_HAS_MMAP
+
+/**
+ * MappedUlidFile maps a file of 16 byte records written with MarshalBinaryTo
+ * (big endian, back to back, no header) read only into memory, and views it as
+ * a read only array of ULIDs without reading or copying it up front. Pages are
+ * faulted in by the kernel as they are touched.
+ *
+ * Where the representation stores ULIDs in the same big endian byte order
+ * (Native: ulid::bytes::ULID, and the integer ones on big endian machines) the
+ * records are the ULIDs, iterators are plain pointers and data() returns the
+ * array, which can be given to UlidIndex. Elsewhere iterators are
+ * BinaryIterators, decoding each record as it is read, two byte swapped loads.
+ * LowerBound and UpperBound bisect the records with either.
+ *
+ * Open and Advise return false on failure, with errno set.
+ * */
+template <class ULID>
+class MappedUlidFile {
+public:
+    /**
+     * Native tells whether the records on disk are ULIDs in memory.
+     * */
+    static constexpr bool Native = !Storage<ULID>::LittleEndian && sizeof(ULID) == 16;
+
+    typedef typename std::conditional<Native, const ULID*, BinaryIterator<ULID>>::type const_iterator;
+    typedef const_iterator iterator;
+
+    /**
+     * Access hints, passed to madvise.
+     * */
+    enum Access {
+        Normal = MADV_NORMAL,
+        Sequential = MADV_SEQUENTIAL,  // read ahead aggressively, drop pages behind
+        Random = MADV_RANDOM,          // no read ahead, for lookups
+        WillNeed = MADV_WILLNEED,      // start reading the whole file in now
+    };
+
+    MappedUlidFile() = default;
+
+    MappedUlidFile(const MappedUlidFile&) = delete;
+    MappedUlidFile& operator=(const MappedUlidFile&) = delete;
+
+    MappedUlidFile(MappedUlidFile&& other) noexcept
+        : records(std::exchange(other.records, nullptr)), n(std::exchange(other.n, 0)) {}
+
+    MappedUlidFile& operator=(MappedUlidFile&& other) noexcept {
+        if (this != &other) {
+            Close();
+            records = std::exchange(other.records, nullptr);
+            n = std::exchange(other.n, 0);
+        }
+        return *this;
+    }
+
+    ~MappedUlidFile() {
+        Close();
+    }
+
+    /**
+     * Open maps the file at path, closing any file mapped before. A file whose
+     * size is not a multiple of 16 fails with EINVAL.
+     * */
+    bool Open(const std::string& path) {
+        Close();
+
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int error = errno;
+            ::close(fd);
+            errno = error;
+            return false;
+        }
+        if (st.st_size % 16 != 0) {
+            ::close(fd);
+            errno = EINVAL;
+            return false;
+        }
+
+        // mmap rejects empty mappings, an empty file is an empty view
+        if (st.st_size > 0) {
+            void* p = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (p == MAP_FAILED) {
+                int error = errno;
+                ::close(fd);
+                errno = error;
+                return false;
+            }
+            records = static_cast<const uint8_t*>(p);
+            n = static_cast<size_t>(st.st_size) / 16;
+        }
+
+        // the mapping holds its own reference to the file
+        ::close(fd);
+        return true;
+    }
+
+    /**
+     * Close unmaps the file, leaving an empty view. Iterators and pointers
+     * into it are invalidated.
+     * */
+    void Close() {
+        if (records != nullptr) {
+            ::munmap(const_cast<uint8_t*>(records), 16 * n);
+        }
+        records = nullptr;
+        n = 0;
+    }
+
+    /**
+     * Advise tells the kernel how the whole file is about to be read.
+     * */
+    bool Advise(Access access) const {
+        return Advise(access, 0, n);
+    }
+
+    /**
+     * Advise tells the kernel how the records [first, first + count) are about
+     * to be read, widened to whole pages.
+     * */
+    bool Advise(Access access, size_t first, size_t count) const {
+        if (count == 0) {
+            return true;
+        }
+
+        const uintptr_t page = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(records + 16 * first) / page * page;
+        const uintptr_t end = reinterpret_cast<uintptr_t>(records + 16 * (first + count));
+        return ::madvise(reinterpret_cast<void*>(begin), end - begin, static_cast<int>(access)) == 0;
+    }
+
+    bool IsOpen() const {
+        return records != nullptr;
+    }
+
+    size_t size() const {
+        return n;
+    }
+
+    bool empty() const {
+        return n == 0;
+    }
+
+    /**
+     * data is the records as ULIDs, only where they are the same (Native).
+     * */
+    const ULID* data() const {
+        static_assert(Native, "the records are not in the representation's byte order, use the iterators");
+        return reinterpret_cast<const ULID*>(records);
+    }
+
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L
+    std::span<const ULID> span() const {
+        return std::span<const ULID>(data(), n);
+    }
+#endif
+
+    const_iterator begin() const {
+        if constexpr (Native) {
+            return reinterpret_cast<const ULID*>(records);
+        } else {
+            return BinaryIterator<ULID>(records);
+        }
+    }
+
+    const_iterator end() const {
+        return begin() + n;
+    }
+
+    ULID operator[](size_t i) const {
+        return begin()[i];
+    }
+
+    ULID front() const {
+        return (*this)[0];
+    }
+
+    ULID back() const {
+        return (*this)[n - 1];
+    }
+
+    /**
+     * LowerBound is the position of the first record not less than ulid,
+     * size() when past the end. The records must be sorted.
+     * */
+    size_t LowerBound(const ULID& ulid) const {
+        return Bisect([&](const ULID& u) { return Less(u, ulid); });
+    }
+
+    /**
+     * UpperBound is the position of the first record greater than ulid.
+     * */
+    size_t UpperBound(const ULID& ulid) const {
+        return Bisect([&](const ULID& u) { return !Less(ulid, u); });
+    }
+
+    /**
+     * Bytes is the mapped file itself.
+     * */
+    const uint8_t* Bytes() const {
+        return records;
+    }
+
+private:
+    // Bisect is the position of the first record failing predicate, which
+    // holds for a prefix of them.
+    template <class Predicate>
+    size_t Bisect(Predicate predicate) const {
+        size_t first = 0, last = n;
+        while (first < last) {
+            const size_t mid = first + (last - first) / 2;
+            if (predicate((*this)[mid])) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+        return first;
+    }
+
+    const uint8_t* records = nullptr;
+    size_t n = 0;
+};
+
+#endif // ULID_HAS_MMAP
+
+};  // namespace core
+
+};  // namespace ulid
+
+#endif // ULID_FILE_HH
@@ -0,0 +1,598 @@
+#ifndef ULID_FLAT_HH
+#define ULID_FLAT_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if !defined(ULID_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define ULID_FLAT_SSE2
+#endif
+
+#include "ulid_core.hh"
+
+namespace ulid {
+
+namespace flat {
+
+/**
+ * The control byte of each slot: Empty, Deleted (a tombstone left by erase),
+ * or, when full, the low 7 bits of the hash of its ULID. Only full slots have
+ * the sign bit clear.
+ * */
+typedef int8_t ctrl_t;
+
+inline constexpr ctrl_t Empty = -128;
+inline constexpr ctrl_t Deleted = -2;
+
+/**
+ * Group is the number of control bytes probed at once, one SSE2 register.
+ * */
+inline constexpr size_t Group = 16;
+
+#ifdef ULID_FLAT_SSE2
+
+/**
+ * Match is the bitmask of the control bytes of the group at g equal to h2.
+ * */
+inline uint32_t Match(const ctrl_t* g, ctrl_t h2) {
+    const __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(g));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2))));
+}
+
+/**
+ * MatchEmpty is the bitmask of the Empty slots of the group at g.
+ * */
+inline uint32_t MatchEmpty(const ctrl_t* g) {
+    return Match(g, Empty);
+}
+
+/**
+ * MatchFree is the bitmask of the Empty or Deleted slots of the group at g,
+ * the sign bits.
+ * */
+inline uint32_t MatchFree(const ctrl_t* g) {
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(g))));
+}
+
+#else
+
+inline uint32_t Match(const ctrl_t* g, ctrl_t h2) {
+    uint32_t mask = 0;
+    for (size_t i = 0 ; i < Group ; i++) {
+        mask |= uint32_t(g[i] == h2) << i;
+    }
+    return mask;
+}
+
+inline uint32_t MatchEmpty(const ctrl_t* g) {
+    return Match(g, Empty);
+}
+
+inline uint32_t MatchFree(const ctrl_t* g) {
+    uint32_t mask = 0;
+    for (size_t i = 0 ; i < Group ; i++) {
+        mask |= uint32_t(g[i] < 0) << i;
+    }
+    return mask;
+}
+
+#endif // ULID_FLAT_SSE2
+
+/**
+ * LowestBit is the index of the lowest set bit of a non zero mask.
+ * */
+inline int LowestBit(uint32_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int i = 0;
+    while ((mask & 1) == 0) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+template <class ULID, class T>
+struct Slot {
+    typedef std::pair<const ULID, T> type;
+
+    static const ULID& Key(const type& slot) {
+        return slot.first;
+    }
+};
+
+template <class ULID>
+struct Slot<ULID, void> {
+    typedef ULID type;
+
+    static const ULID& Key(const type& slot) {
+        return slot;
+    }
+};
+
+};  // namespace flat
+
+namespace core {
+
+/**
+ * FlatTable is an open addressing hash table of ULIDs, the set (T = void) or
+ * map (ULID to T) behind UlidFlatSet and UlidFlatMap.
+ *
+ * It is laid out like a Swiss table: an array of slots holding the entries
+ * in place, and an array of one control byte per slot, holding 7 bits of the
+ * hash of the ULID in it. A lookup hashes the ULID once, then compares 16
+ * control bytes at a time against its 7 bits with one SSE2 compare, and only
+ * looks at the slots that match, so a lookup touches one group of control
+ * bytes and almost always a single slot, whether the ULID is there or not.
+ * Groups are probed triangularly from the hash.
+ *
+ * The table grows to twice its capacity (a power of two, 16 at least) when
+ * 7/8 of the slots are taken, so a set of ULIDs costs 17 bytes per slot, 19.4
+ * to 38.9 bytes per entry. Erase leaves tombstones, which the next growth
+ * clears.
+ *
+ * Growing and rehashing invalidate iterators and pointers to entries, like
+ * std::vector, unlike std::unordered_set.
+ * */
+template <class ULID, class T, class Hasher = Hash<ULID>>
+class FlatTable {
+public:
+    typedef ULID key_type;
+    typedef typename flat::Slot<ULID, T>::type value_type;
+    typedef size_t size_type;
+
+    template <bool Const>
+    class Iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef typename FlatTable::value_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef typename std::conditional<Const, const value_type*, value_type*>::type pointer;
+        typedef typename std::conditional<Const, const value_type&, value_type&>::type reference;
+
+        Iterator() = default;
+
+        // an iterator converts to a const_iterator
+        template <bool C = Const, typename std::enable_if<C, int>::type = 0>
+        Iterator(const Iterator<false>& it) : ctrl(it.ctrl), slot(it.slot), end(it.end) {}
+
+        reference operator*() const {
+            return *slot;
+        }
+
+        pointer operator->() const {
+            return slot;
+        }
+
+        Iterator& operator++() {
+            ++ctrl;
+            ++slot;
+            Skip();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator it = *this;
+            ++*this;
+            return it;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) {
+            return a.ctrl == b.ctrl;
+        }
+
+        friend bool operator!=(const Iterator& a, const Iterator& b) {
+            return a.ctrl != b.ctrl;
+        }
+
+    private:
+        friend class FlatTable;
+        template <bool> friend class Iterator;
+
+        Iterator(const flat::ctrl_t* ctrl, pointer slot, const flat::ctrl_t* end) : ctrl(ctrl), slot(slot), end(end) {}
+
+        void Skip() {
+            while (ctrl != end && *ctrl < 0) {
+                ++ctrl;
+                ++slot;
+            }
+        }
+
+        const flat::ctrl_t* ctrl = nullptr;
+        pointer slot = nullptr;
+        const flat::ctrl_t* end = nullptr;
+    };
+
+    typedef Iterator<false> iterator;
+    typedef Iterator<true> const_iterator;
+
+    FlatTable() = default;
+
+    explicit FlatTable(size_t n) {
+        reserve(n);
+    }
+
+    FlatTable(const FlatTable& other) {
+        reserve(other.n);
+        for (const value_type& v : other) {
+            Insert(flat::Slot<ULID, T>::Key(v), v);
+        }
+    }
+
+    FlatTable(FlatTable&& other) noexcept
+        : ctrl(std::exchange(other.ctrl, nullptr)),
+          slots(std::exchange(other.slots, nullptr)),
+          cap(std::exchange(other.cap, 0)),
+          n(std::exchange(other.n, 0)),
+          growth_left(std::exchange(other.growth_left, 0)),
+          hasher(other.hasher) {}
+
+    FlatTable& operator=(const FlatTable& other) {
+        if (this != &other) {
+            FlatTable copy(other);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    FlatTable& operator=(FlatTable&& other) noexcept {
+        if (this != &other) {
+            Release();
+            ctrl = std::exchange(other.ctrl, nullptr);
+            slots = std::exchange(other.slots, nullptr);
+            cap = std::exchange(other.cap, 0);
+            n = std::exchange(other.n, 0);
+            growth_left = std::exchange(other.growth_left, 0);
+            hasher = other.hasher;
+        }
+        return *this;
+    }
+
+    ~FlatTable() {
+        Release();
+    }
+
+    void swap(FlatTable& other) noexcept {
+        std::swap(ctrl, other.ctrl);
+        std::swap(slots, other.slots);
+        std::swap(cap, other.cap);
+        std::swap(n, other.n);
+        std::swap(growth_left, other.growth_left);
+        std::swap(hasher, other.hasher);
+    }
+
+    iterator begin() {
+        iterator it(ctrl, slots, ctrl + cap);
+        it.Skip();
+        return it;
+    }
+
+    iterator end() {
+        return iterator(ctrl + cap, slots + cap, ctrl + cap);
+    }
+
+    const_iterator begin() const {
+        const_iterator it(ctrl, slots, ctrl + cap);
+        it.Skip();
+        return it;
+    }
+
+    const_iterator end() const {
+        return const_iterator(ctrl + cap, slots + cap, ctrl + cap);
+    }
+
+    size_t size() const {
+        return n;
+    }
+
+    bool empty() const {
+        return n == 0;
+    }
+
+    /**
+     * capacity is the number of slots, 8/7 of the entries that fit before
+     * the table grows.
+     * */
+    size_t capacity() const {
+        return cap;
+    }
+
+    /**
+     * AllocatedBytes is the memory held by the slots and control bytes.
+     * */
+    size_t AllocatedBytes() const {
+        return cap == 0 ? 0 : cap * sizeof(value_type) + cap + flat::Group - 1;
+    }
+
+    /**
+     * clear removes every entry, keeping the capacity.
+     * */
+    void clear() {
+        if (cap == 0) {
+            return;
+        }
+        Destroy();
+        std::memset(ctrl, flat::Empty, cap + flat::Group - 1);
+        n = 0;
+        growth_left = MaxLoad(cap);
+    }
+
+    /**
+     * reserve makes room for count entries without growing.
+     * */
+    void reserve(size_t count) {
+        if (count > MaxLoad(cap)) {
+            Rehash(CapacityFor(count));
+        }
+    }
+
+    iterator find(const ULID& key) {
+        const size_t i = Find(key);
+        return i == cap ? end() : At(i);
+    }
+
+    const_iterator find(const ULID& key) const {
+        const size_t i = Find(key);
+        return i == cap ? end() : const_iterator(ctrl + i, slots + i, ctrl + cap);
+    }
+
+    bool contains(const ULID& key) const {
+        return Find(key) != cap;
+    }
+
+    size_t count(const ULID& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    /**
+     * Prefetch starts loading the control bytes and the first slot a lookup
+     * of key will read, for batches that look up one key while the next ones
+     * are on their way.
+     * */
+    void Prefetch(const ULID& key) const {
+#if defined(__GNUC__) || defined(__clang__)
+        if (cap != 0) {
+            const size_t pos = (hasher(key) >> 7) & (cap - 1);
+            __builtin_prefetch(ctrl + pos);
+            __builtin_prefetch(slots + pos);
+        }
+#else
+        (void)key;
+#endif
+    }
+
+    /**
+     * insert adds a ULID to a set, or a (ULID, value) pair to a map, if the
+     * ULID is not there yet, and returns where it is and whether it was added.
+     * */
+    std::pair<iterator, bool> insert(const value_type& value) {
+        return Insert(flat::Slot<ULID, T>::Key(value), value);
+    }
+
+    std::pair<iterator, bool> insert(value_type&& value) {
+        const ULID key = flat::Slot<ULID, T>::Key(value);
+        return Insert(key, std::move(value));
+    }
+
+    /**
+     * try_emplace adds the ULID to a map with a value made of args, if it is
+     * not there yet.
+     * */
+    template <class... Args, class U = T, typename std::enable_if<!std::is_void<U>::value, int>::type = 0>
+    std::pair<iterator, bool> try_emplace(const ULID& key, Args&&... args) {
+        return Insert(key, std::piecewise_construct, std::forward_as_tuple(key),
+                      std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    /**
+     * operator[] is the value of a ULID in a map, added value initialized if
+     * it is not there yet.
+     * */
+    template <class U = T, typename std::enable_if<!std::is_void<U>::value, int>::type = 0>
+    U& operator[](const ULID& key) {
+        return try_emplace(key).first->second;
+    }
+
+    /**
+     * erase removes a ULID, and returns whether it was there.
+     * */
+    size_t erase(const ULID& key) {
+        const size_t i = Find(key);
+        if (i == cap) {
+            return 0;
+        }
+        EraseAt(i);
+        return 1;
+    }
+
+    /**
+     * erase removes the entry at it, and returns the one after it.
+     * */
+    iterator erase(const_iterator it) {
+        const size_t i = static_cast<size_t>(it.ctrl - ctrl);
+        EraseAt(i);
+        iterator next(ctrl + i, slots + i, ctrl + cap);
+        next.Skip();
+        return next;
+    }
+
+private:
+    // at most 7/8 of the slots are taken
+    static constexpr size_t MaxLoad(size_t capacity) {
+        return capacity - capacity / 8;
+    }
+
+    static size_t CapacityFor(size_t count) {
+        size_t capacity = flat::Group;
+        while (MaxLoad(capacity) < count) {
+            capacity *= 2;
+        }
+        return capacity;
+    }
+
+    iterator At(size_t i) {
+        return iterator(ctrl + i, slots + i, ctrl + cap);
+    }
+
+    // SetCtrl also writes the copy of the first Group - 1 control bytes past
+    // the end, so a group starting near the end wraps around.
+    void SetCtrl(size_t i, flat::ctrl_t h) {
+        ctrl[i] = h;
+        if (i < flat::Group - 1) {
+            ctrl[cap + i] = h;
+        }
+    }
+
+    size_t Find(const ULID& key) const {
+        return cap == 0 ? cap : Find(key, hasher(key));
+    }
+
+    // Find is the slot holding key, whose hash is hash, cap if there is none.
+    size_t Find(const ULID& key, size_t hash) const {
+        const flat::ctrl_t h2 = static_cast<flat::ctrl_t>(hash & 0x7F);
+        const size_t mask = cap - 1;
+        size_t pos = (hash >> 7) & mask;
+        for (size_t step = flat::Group ; ; step += flat::Group) {
+            const flat::ctrl_t* g = ctrl + pos;
+            for (uint32_t m = flat::Match(g, h2) ; m != 0 ; m &= m - 1) {
+                const size_t i = (pos + static_cast<size_t>(flat::LowestBit(m))) & mask;
+                if (Equal(flat::Slot<ULID, T>::Key(slots[i]), key)) {
+                    return i;
+                }
+            }
+            if (flat::MatchEmpty(g) != 0) {
+                return cap;
+            }
+            pos = (pos + step) & mask;
+        }
+    }
+
+    // FindFree is the first Empty or Deleted slot on the probe sequence of hash.
+    size_t FindFree(size_t hash) const {
+        const size_t mask = cap - 1;
+        size_t pos = (hash >> 7) & mask;
+        for (size_t step = flat::Group ; ; step += flat::Group) {
+            const uint32_t m = flat::MatchFree(ctrl + pos);
+            if (m != 0) {
+                return (pos + static_cast<size_t>(flat::LowestBit(m))) & mask;
+            }
+            pos = (pos + step) & mask;
+        }
+    }
+
+    template <class... Args>
+    std::pair<iterator, bool> Insert(const ULID& key, Args&&... args) {
+        const size_t hash = hasher(key);
+        const size_t found = cap == 0 ? cap : Find(key, hash);
+        if (found != cap) {
+            return {At(found), false};
+        }
+
+        size_t i = cap == 0 ? 0 : FindFree(hash);
+        if (cap == 0 || (growth_left == 0 && ctrl[i] != flat::Deleted)) {
+            // twice the size, or the same size when most of the taken slots are tombstones
+            Rehash(cap == 0 ? flat::Group : n >= MaxLoad(cap) / 2 ? 2 * cap : cap);
+            i = FindFree(hash);
+        }
+
+        new (&slots[i]) value_type(std::forward<Args>(args)...);
+        if (ctrl[i] == flat::Empty) {
+            growth_left--;
+        }
+        SetCtrl(i, static_cast<flat::ctrl_t>(hash & 0x7F));
+        n++;
+        return {At(i), true};
+    }
+
+    void EraseAt(size_t i) {
+        slots[i].~value_type();
+        SetCtrl(i, flat::Deleted);
+        n--;
+    }
+
+    // Rehash moves every entry into a new table of capacity slots.
+    void Rehash(size_t capacity) {
+        flat::ctrl_t* old_ctrl = ctrl;
+        value_type* old_slots = slots;
+        const size_t old_cap = cap;
+
+        ctrl = new flat::ctrl_t[capacity + flat::Group - 1];
+        std::memset(ctrl, flat::Empty, capacity + flat::Group - 1);
+        slots = std::allocator<value_type>().allocate(capacity);
+        cap = capacity;
+        growth_left = MaxLoad(capacity) - n;
+
+        for (size_t i = 0 ; i < old_cap ; i++) {
+            if (old_ctrl[i] >= 0) {
+                const size_t hash = hasher(flat::Slot<ULID, T>::Key(old_slots[i]));
+                const size_t j = FindFree(hash);
+                new (&slots[j]) value_type(std::move(old_slots[i]));
+                old_slots[i].~value_type();
+                SetCtrl(j, static_cast<flat::ctrl_t>(hash & 0x7F));
+            }
+        }
+
+        if (old_cap != 0) {
+            delete[] old_ctrl;
+            std::allocator<value_type>().deallocate(old_slots, old_cap);
+        }
+    }
+
+    void Destroy() {
+        if (!std::is_trivially_destructible<value_type>::value) {
+            for (size_t i = 0 ; i < cap ; i++) {
+                if (ctrl[i] >= 0) {
+                    slots[i].~value_type();
+                }
+            }
+        }
+    }
+
+    void Release() {
+        if (cap == 0) {
+            return;
+        }
+        Destroy();
+        delete[] ctrl;
+        std::allocator<value_type>().deallocate(slots, cap);
+        ctrl = nullptr;
+        slots = nullptr;
+        cap = 0;
+        n = 0;
+        growth_left = 0;
+    }
+
+    flat::ctrl_t* ctrl = nullptr;
+    value_type* slots = nullptr;
+    size_t cap = 0;
+    size_t n = 0;
+    size_t growth_left = 0;
+    Hasher hasher;
+};
+
+/**
+ * UlidFlatSet is a FlatTable set of ULIDs.
+ * */
+template <class ULID, class Hasher = Hash<ULID>>
+using UlidFlatSet = FlatTable<ULID, void, Hasher>;
+
+/**
+ * UlidFlatMap is a FlatTable map from ULIDs to T.
+ * */
+template <class ULID, class T, class Hasher = Hash<ULID>>
+using UlidFlatMap = FlatTable<ULID, T, Hasher>;
+
+};  // namespace core
+
+};  // namespace ulid
+
+#endif // ULID_FLAT_HH
@@ -0,0 +1,245 @@
+#ifndef ULID_PARTITION_HH
+#define ULID_PARTITION_HH
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+#include "ulid_core.hh"
+
+namespace ulid {
+
+namespace core {
+
+/**
+ * EntropyLayout splits the 80 bits of entropy into a node ID, a sequence and
+ * random bits, in that order from the most significant:
+ *
+ *   | 48 bit timestamp | node_bits | sequence_bits | random bits |
+ *
+ * With a node ID unique to each generator process across a fleet and a
+ * sequence that never repeats within a millisecond in a process, which
+ * PartitionedGenerator guarantees, two ULIDs can only be equal if they came
+ * from the same process in the same millisecond with the same sequence, so
+ * they never are, and downstream systems need no global dedup. The timestamp
+ * still leads, so ULIDs keep sorting by time.
+ *
+ * node_bits can be up to 64 and sequence_bits up to 16 (65536 ULIDs per
+ * millisecond per process), together at most 80.
+ * */
+struct EntropyLayout {
+    int node_bits = 0;
+    int sequence_bits = 0;
+
+    constexpr int RandomBits() const {
+        return 80 - node_bits - sequence_bits;
+    }
+
+    constexpr bool Valid() const {
+        return node_bits >= 0 && node_bits <= 64 && sequence_bits >= 0 && sequence_bits <= 16 &&
+               node_bits + sequence_bits <= 80;
+    }
+
+    /**
+     * MaxNode is the largest node ID that fits.
+     * */
+    constexpr uint64_t MaxNode() const {
+        return node_bits == 64 ? ~uint64_t(0) : (uint64_t(1) << node_bits) - 1;
+    }
+
+    /**
+     * MaxSequence is the largest sequence that fits.
+     * */
+    constexpr uint64_t MaxSequence() const {
+        return (uint64_t(1) << sequence_bits) - 1;
+    }
+};
+
+namespace partition {
+
+constexpr uint64_t Mask(int width) {
+    return width >= 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+}
+
+/**
+ * Field reads width bits (at most 64) of the entropy of a ULID, starting shift
+ * bits up from the least significant.
+ * */
+template <class ULID>
+inline constexpr uint64_t Field(const ULID& ulid, int shift, int width) {
+    const uint64_t hi = Storage<ULID>::Hi(ulid) & 0xFFFF, lo = Storage<ULID>::Lo(ulid);
+    uint64_t v;
+    if (shift >= 64) {
+        v = hi >> (shift - 64);
+    } else if (shift == 0) {
+        v = lo;
+    } else {
+        v = (lo >> shift) | (hi << (64 - shift));
+    }
+    return v & Mask(width);
+}
+
+/**
+ * SetField replaces width bits of the entropy of a ULID, starting shift bits up
+ * from the least significant, with value.
+ * */
+template <class ULID>
+inline constexpr void SetField(ULID& ulid, int shift, int width, uint64_t value) {
+    if (width == 0) {
+        return;
+    }
+    value &= Mask(width);
+
+    uint64_t hi = Storage<ULID>::Hi(ulid), lo = Storage<ULID>::Lo(ulid);
+    if (shift < 64) {
+        const uint64_t mask = Mask(width) << shift;
+        lo = (lo & ~mask) | (value << shift);
+    }
+    if (shift + width > 64) {
+        const uint64_t mask = shift >= 64 ? Mask(width) << (shift - 64) : Mask(width) >> (64 - shift);
+        const uint64_t bits = shift >= 64 ? value << (shift - 64) : value >> (64 - shift);
+        hi = (hi & ~mask) | bits;
+    }
+    Storage<ULID>::Set(ulid, hi, lo);
+}
+
+};  // namespace partition
+
+/**
+ * EncodePartitionedEntropy fills the entropy of a ULID with random bits from
+ * rng, see EncodeEntropy, and then writes node and sequence into their fields.
+ * Both are truncated to their widths.
+ * */
+template <class Rng, class ULID>
+inline void EncodePartitionedEntropy(const EntropyLayout& layout, uint64_t node, uint64_t sequence,
+                                     Rng&& rng, ULID& ulid) {
+    EncodeEntropy(rng, ulid);
+    partition::SetField(ulid, 80 - layout.node_bits, layout.node_bits, node);
+    partition::SetField(ulid, layout.RandomBits(), layout.sequence_bits, sequence);
+}
+
+/**
+ * EncodePartitionedEntropy draws the random bits from the calling thread's
+ * DefaultGenerator.
+ * */
+template <class ULID>
+inline void EncodePartitionedEntropy(const EntropyLayout& layout, uint64_t node, uint64_t sequence, ULID& ulid) {
+    EncodePartitionedEntropy(layout, node, sequence, DefaultGenerator(), ulid);
+}
+
+/**
+ * ExtractNode reads the node ID of a ULID encoded with layout.
+ * */
+template <class ULID>
+inline constexpr uint64_t ExtractNode(const EntropyLayout& layout, const ULID& ulid) {
+    return layout.node_bits == 0 ? 0 : partition::Field(ulid, 80 - layout.node_bits, layout.node_bits);
+}
+
+/**
+ * ExtractSequence reads the sequence of a ULID encoded with layout.
+ * */
+template <class ULID>
+inline constexpr uint64_t ExtractSequence(const EntropyLayout& layout, const ULID& ulid) {
+    return layout.sequence_bits == 0 ? 0 : partition::Field(ulid, layout.RandomBits(), layout.sequence_bits);
+}
+
+/**
+ * PartitionedGenerator creates ULIDs with a fixed node ID and a sequence that
+ * starts at 0 every millisecond and counts up, the rest of the entropy random.
+ * Within a process they sort in creation order.
+ *
+ * The millisecond and the sequence are a single 64 bit word updated with a
+ * compare and swap, so one generator, with one node ID, can be shared by every
+ * thread of a process. If the clock steps back the last millisecond is kept,
+ * like MonotonicGenerator.
+ *
+ * Next returns false, leaving the ULID untouched, when the sequence of a
+ * millisecond is exhausted (with no sequence bits, after the first ULID of
+ * each millisecond), and always when the layout is not Valid or the node ID
+ * does not fit in it.
+ *
+ * Clock is read by Next(ULID&), see ulid_clock.hh.
+ * */
+template <class ULID, class Clock>
+class BasicPartitionedGenerator {
+public:
+    BasicPartitionedGenerator(EntropyLayout layout, uint64_t node, Clock clock = Clock())
+        : layout(layout), node(node), valid(layout.Valid() && node <= layout.MaxNode()), clock(clock) {}
+
+    /**
+     * Next creates the next ULID for the current time, read from the clock,
+     * with random bits from the calling thread's DefaultGenerator.
+     * */
+    bool Next(ULID& ulid) {
+        return Next(clock.Now(), DefaultGenerator(), ulid);
+    }
+
+    /**
+     * Next creates the next ULID for the passed timestamp, with random bits
+     * from the calling thread's DefaultGenerator.
+     * */
+    bool Next(time_t timestamp, ULID& ulid) {
+        return Next(timestamp, DefaultGenerator(), ulid);
+    }
+
+    /**
+     * Next creates the next ULID for the passed timestamp, with random bits
+     * from rng.
+     * */
+    template <class Rng>
+    bool Next(time_t timestamp, Rng&& rng, ULID& ulid) {
+        if (!valid) {
+            return false;
+        }
+
+        const int bits = layout.sequence_bits;
+        const uint64_t now = static_cast<uint64_t>(timestamp) & ((uint64_t(1) << 48) - 1);
+
+        uint64_t last = state.load(std::memory_order_relaxed), next;
+        do {
+            if (last == 0 || now > (last - 1) >> bits) {
+                next = (now << bits) + 1;
+            } else if (((last - 1) & layout.MaxSequence()) == layout.MaxSequence()) {
+                // the sequence of the millisecond is used up
+                return false;
+            } else {
+                next = last + 1;
+            }
+        } while (!state.compare_exchange_weak(last, next, std::memory_order_relaxed));
+
+        const uint64_t issued = next - 1;
+        EncodeTime(static_cast<time_t>(issued >> bits), ulid);
+        EncodePartitionedEntropy(layout, node, issued & layout.MaxSequence(), rng, ulid);
+        return true;
+    }
+
+    const EntropyLayout& Layout() const {
+        return layout;
+    }
+
+    uint64_t Node() const {
+        return node;
+    }
+
+private:
+    const EntropyLayout layout;
+    const uint64_t node;
+    const bool valid;
+    Clock clock;
+
+    // the millisecond of the last ULID shifted up and its sequence, plus one,
+    // 0 before the first
+    std::atomic<uint64_t> state{0};
+};
+
+/**
+ * PartitionedGenerator is a BasicPartitionedGenerator reading clocks::DefaultClock.
+ * */
+template <class ULID>
+using PartitionedGenerator = BasicPartitionedGenerator<ULID, clocks::DefaultClock>;
+
+};  // namespace core
+
+};  // namespace ulid
+
+#endif // ULID_PARTITION_HH
@@ -0,0 +1,212 @@
+#ifndef ULID_SORT_HH
+#define ULID_SORT_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "ulid_core.hh"
+
+namespace ulid {
+
+namespace radix {
+
+/**
+ * SmallBucket is the size below which a bucket is left to std::sort, where a
+ * 256 entry histogram no longer pays for itself.
+ * */
+inline constexpr size_t SmallBucket = 256;
+
+/**
+ * ParallelChunk is the least number of ULIDs given to each thread, smaller
+ * inputs use fewer threads.
+ * */
+inline constexpr size_t ParallelChunk = 1 << 16;
+
+/**
+ * Digit returns the 8 bits of a ULID starting at bit, counted from the most
+ * significant, zero filled past the end.
+ * */
+template <class ULID>
+inline uint8_t Digit(const ULID& ulid, int bit) {
+    uint64_t word;
+    if (bit == 0) {
+        word = Storage<ULID>::Hi(ulid);
+    } else if (bit < 64) {
+        word = (Storage<ULID>::Hi(ulid) << bit) | (Storage<ULID>::Lo(ulid) >> (64 - bit));
+    } else {
+        word = Storage<ULID>::Lo(ulid) << (bit - 64);
+    }
+    return static_cast<uint8_t>(word >> 56);
+}
+
+/**
+ * SortBucket sorts the n ULIDs in a by their bits from bit on, all of them
+ * sharing the bits before it, using b as scratch space of the same size.
+ *
+ * Each level scatters from one array to the other, so the sorted bucket ends
+ * up in b when flip is set and in a otherwise. A digit shared by every ULID in
+ * the bucket costs a histogram but no scatter.
+ * */
+template <class ULID>
+inline void SortBucket(ULID* a, ULID* b, size_t n, int bit, bool flip) {
+    for ( ; bit < 128 && n >= SmallBucket ; bit += 8) {
+        size_t count[256] = {};
+        for (size_t i = 0 ; i < n ; i++) {
+            count[Digit(a[i], bit)]++;
+        }
+
+        if (count[Digit(a[0], bit)] == n) {
+            continue;
+        }
+
+        size_t offset[256];
+        size_t sum = 0;
+        for (int d = 0 ; d < 256 ; d++) {
+            offset[d] = sum;
+            sum += count[d];
+        }
+
+        for (size_t i = 0 ; i < n ; i++) {
+            b[offset[Digit(a[i], bit)]++] = a[i];
+        }
+
+        size_t start = 0;
+        for (int d = 0 ; d < 256 ; d++) {
+            SortBucket(b + start, a + start, count[d], bit + 8, !flip);
+            start += count[d];
+        }
+        return;
+    }
+
+    if (bit < 128) {
+        std::sort(a, a + n, [](const ULID& x, const ULID& y) { return core::Less(x, y); });
+    }
+    if (flip) {
+        std::copy(a, a + n, b);
+    }
+}
+
+/**
+ * Parallel runs fn(t) for t in [0, threads), t = 0 on the calling thread.
+ * */
+template <class Fn>
+inline void Parallel(unsigned threads, Fn fn) {
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    for (unsigned t = 1 ; t < threads ; t++) {
+        workers.emplace_back(fn, t);
+    }
+    fn(0u);
+    for (auto& w : workers) {
+        w.join();
+    }
+}
+
+};  // namespace radix
+
+namespace core {
+
+/**
+ * Sort sorts n ULIDs in ascending order, the same order as CompareULIDs and
+ * std::sort, with an MSD radix sort over 8 bit digits of the 128 bit key.
+ *
+ * A first pass finds the leading bits shared by every ULID, commonly the top
+ * of the timestamp when the input spans a day or less, and the digits start
+ * right after them. The first digit is counted and scattered by up to threads
+ * threads (0 for std::thread::hardware_concurrency), and the 256 buckets it
+ * produces are sorted by the same threads, taking buckets off a shared counter.
+ *
+ * Allocates scratch space for n ULIDs.
+ * */
+template <class ULID>
+inline void Sort(ULID* ulids, size_t n, unsigned threads = 0) {
+    if (n < radix::SmallBucket) {
+        std::sort(ulids, ulids + n, [](const ULID& x, const ULID& y) { return Less(x, y); });
+        return;
+    }
+
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threads = static_cast<unsigned>(std::min<size_t>(threads, n / radix::ParallelChunk + 1));
+
+    auto chunk = [n, threads](unsigned t) { return n / threads * t + std::min<size_t>(t, n % threads); };
+
+    // bits that differ from the first ULID anywhere in the input
+    std::vector<uint64_t> diff(2 * threads);
+    const uint64_t hi0 = Storage<ULID>::Hi(ulids[0]), lo0 = Storage<ULID>::Lo(ulids[0]);
+    radix::Parallel(threads, [&](unsigned t) {
+        uint64_t hi = 0, lo = 0;
+        for (size_t i = chunk(t), end = chunk(t + 1) ; i < end ; i++) {
+            hi |= Storage<ULID>::Hi(ulids[i]) ^ hi0;
+            lo |= Storage<ULID>::Lo(ulids[i]) ^ lo0;
+        }
+        diff[2 * t] = hi;
+        diff[2 * t + 1] = lo;
+    });
+
+    uint64_t hi = 0, lo = 0;
+    for (unsigned t = 0 ; t < threads ; t++) {
+        hi |= diff[2 * t];
+        lo |= diff[2 * t + 1];
+    }
+
+    int bit = 0;
+    for (uint64_t word = hi ; bit < 64 && (word >> 63) == 0 ; bit++, word <<= 1) {}
+    for (uint64_t word = lo ; bit >= 64 && bit < 128 && (word >> 63) == 0 ; bit++, word <<= 1) {}
+    if (bit == 128) {
+        return;
+    }
+
+    std::unique_ptr<ULID, void (*)(ULID*)> scratch(
+        static_cast<ULID*>(::operator new(n * sizeof(ULID), std::align_val_t(alignof(ULID)))),
+        [](ULID* b) { ::operator delete(b, std::align_val_t(alignof(ULID))); });
+    ULID* buffer = scratch.get();
+
+    // count and scatter the first digit, each thread its own chunk
+    std::vector<size_t> count(256 * threads);
+    radix::Parallel(threads, [&](unsigned t) {
+        size_t* c = &count[256 * t];
+        for (size_t i = chunk(t), end = chunk(t + 1) ; i < end ; i++) {
+            c[radix::Digit(ulids[i], bit)]++;
+        }
+    });
+
+    std::vector<size_t> offset(256 * threads);
+    size_t start[257];
+    size_t sum = 0;
+    for (int d = 0 ; d < 256 ; d++) {
+        start[d] = sum;
+        for (unsigned t = 0 ; t < threads ; t++) {
+            offset[256 * t + d] = sum;
+            sum += count[256 * t + d];
+        }
+    }
+    start[256] = n;
+
+    radix::Parallel(threads, [&](unsigned t) {
+        size_t* o = &offset[256 * t];
+        for (size_t i = chunk(t), end = chunk(t + 1) ; i < end ; i++) {
+            buffer[o[radix::Digit(ulids[i], bit)]++] = ulids[i];
+        }
+    });
+
+    // sort the buckets back into ulids
+    std::atomic<int> next(0);
+    radix::Parallel(threads, [&](unsigned) {
+        for (int d = next++ ; d < 256 ; d = next++) {
+            radix::SortBucket(buffer + start[d], ulids + start[d], start[d + 1] - start[d], bit + 8, true);
+        }
+    });
+}
+
+};  // namespace core
+
+};  // namespace ulid
+
+#endif // ULID_SORT_HH
@@ -0,0 +1,259 @@
+#ifndef ULID_STREAM_HH
+#define ULID_STREAM_HH
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define ULID_HAS_FD
+#endif
+
+#include "ulid_core.hh"
+
+/**
+ * Streaming conversion between newline separated text ULIDs and 16 byte binary
+ * records (big endian, the format of MarshalBinaryTo and MappedUlidFile).
+ *
+ * Neither direction depends on the ULID representation: text is decoded
+ * straight into big endian records and records encoded straight from them,
+ * a block of 64K lines at a time, with the batch Base32 kernels.
+ * */
+
+namespace ulid {
+
+namespace stream {
+
+/**
+ * LineSize is the size of a text line, 26 characters and a newline.
+ * */
+inline constexpr size_t LineSize = 27;
+
+/**
+ * Block is the number of lines or records converted at a time.
+ * */
+inline constexpr size_t Block = 1 << 16;
+
+/**
+ * Result is the outcome of a conversion. count is the number of lines or
+ * records converted, and when status is not OK, line count + 1 (or the
+ * trailing partial record) is the one that was rejected. error is the errno
+ * of a read or write that failed.
+ * */
+struct Result {
+    uint64_t count = 0;
+    Status status = Status::OK;
+    int error = 0;
+
+    bool ok() const {
+        return status == Status::OK && error == 0;
+    }
+};
+
+/**
+ * EncodeLines writes the n records at src to dst as n newline terminated
+ * lines, LineSize * n characters.
+ * */
+inline void EncodeLines(const uint8_t* src, size_t n, char* dst) {
+    if (!base32::EncodeBatch<false>(src, n, dst, LineSize)) {
+        for (size_t i = 0 ; i < n ; i++) {
+            EncodeWords(LoadBigEndian64(src + 16 * i), LoadBigEndian64(src + 16 * i + 8), dst + LineSize * i);
+        }
+    }
+    for (size_t i = 0 ; i < n ; i++) {
+        dst[LineSize * i + 26] = '\n';
+    }
+}
+
+/**
+ * DecodeLines validates and decodes up to n newline terminated lines from
+ * [src, src + len) into records at dst, see TryUnmarshalLines.
+ * */
+inline size_t DecodeLines(const char* src, size_t len, uint8_t* dst, size_t n, size_t* consumed) {
+    return base32::DecodeLines<false>(src, len, n, dst, consumed);
+}
+
+/**
+ * LineStatus tells why the line starting at src, which runs to the first
+ * newline or to src + len, is not a ULID.
+ * */
+inline Status LineStatus(const char* src, size_t len) {
+    const char* newline = static_cast<const char*>(std::memchr(src, '\n', len));
+    size_t n = newline != nullptr ? static_cast<size_t>(newline - src) : len;
+    if (n > 0 && src[n - 1] == '\r') {
+        n--;
+    }
+    if (n != 26) {
+        return Status::InvalidLength;
+    }
+    uint8_t record[16];
+    return base32::Decode<false>(src, record);
+}
+
+/**
+ * TextToBinary reads newline separated text ULIDs with read and writes their
+ * records with write, stopping at the first line that is not a ULID. Lines may
+ * end in "\r\n", and the last one without a newline.
+ *
+ * read(void* dst, size_t n) returns the number of bytes it put in dst, 0 at
+ * the end of the input and a negative number with errno set on failure.
+ * write(const void* src, size_t n) writes all of it, or returns false with
+ * errno set. Each read is converted as soon as it completes a line, so pipes
+ * stream through.
+ * */
+template <class Read, class Write>
+inline Result TextToBinary(Read&& read, Write&& write) {
+    Result result;
+    std::vector<char> text(LineSize * Block);
+    std::vector<uint8_t> records(16 * Block);
+
+    size_t have = 0;
+    for (bool eof = false ; !eof ; ) {
+        if (have == text.size()) {
+            // a whole buffer without a newline
+            result.status = Status::InvalidLength;
+            return result;
+        }
+
+        const ptrdiff_t r = read(text.data() + have, text.size() - have);
+        if (r < 0) {
+            result.error = errno != 0 ? errno : EIO;
+            return result;
+        }
+        eof = r == 0;
+        have += static_cast<size_t>(r);
+
+        // up to the last newline, and everything once the input ends
+        size_t complete = have;
+        while (!eof && complete > 0 && text[complete - 1] != '\n') {
+            complete--;
+        }
+
+        for (size_t pos = 0 ; pos < complete ; ) {
+            size_t consumed = 0;
+            const size_t n = DecodeLines(text.data() + pos, complete - pos, records.data(), Block, &consumed);
+            if (n > 0 && !write(records.data(), 16 * n)) {
+                result.error = errno != 0 ? errno : EIO;
+                return result;
+            }
+            result.count += n;
+            pos += consumed;
+
+            if (n < Block && pos < complete) {
+                result.status = LineStatus(text.data() + pos, complete - pos);
+                return result;
+            }
+        }
+
+        std::memmove(text.data(), text.data() + complete, have - complete);
+        have -= complete;
+    }
+    return result;
+}
+
+/**
+ * BinaryToText reads 16 byte records with read and writes them with write as
+ * newline terminated text ULIDs. A trailing partial record is reported as
+ * Status::InvalidLength, after every whole record has been written.
+ *
+ * read and write are as for TextToBinary.
+ * */
+template <class Read, class Write>
+inline Result BinaryToText(Read&& read, Write&& write) {
+    Result result;
+    std::vector<uint8_t> records(16 * Block);
+    std::vector<char> text(LineSize * Block);
+
+    size_t have = 0;
+    for (;;) {
+        const ptrdiff_t r = read(records.data() + have, records.size() - have);
+        if (r < 0) {
+            result.error = errno != 0 ? errno : EIO;
+            return result;
+        }
+        if (r == 0) {
+            if (have != 0) {
+                result.status = Status::InvalidLength;
+            }
+            return result;
+        }
+        have += static_cast<size_t>(r);
+
+        const size_t n = have / 16;
+        EncodeLines(records.data(), n, text.data());
+        if (n > 0 && !write(text.data(), LineSize * n)) {
+            result.error = errno != 0 ? errno : EIO;
+            return result;
+        }
+        result.count += n;
+
+        std::memmove(records.data(), records.data() + 16 * n, have - 16 * n);
+        have -= 16 * n;
+    }
+}
+
+#ifdef ULID_HAS_FD
+
+/**
+ * FdReader reads from a file descriptor, retrying interrupted reads.
+ * */
+struct FdReader {
+    int fd;
+
+    ptrdiff_t operator()(void* dst, size_t n) const {
+        for (;;) {
+            const ssize_t r = ::read(fd, dst, n);
+            if (r >= 0 || errno != EINTR) {
+                return r;
+            }
+        }
+    }
+};
+
+/**
+ * FdWriter writes all of its input to a file descriptor.
+ * */
+struct FdWriter {
+    int fd;
+
+    bool operator()(const void* src, size_t n) const {
+        const char* p = static_cast<const char*>(src);
+        while (n > 0) {
+            const ssize_t w = ::write(fd, p, n);
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            p += w;
+            n -= static_cast<size_t>(w);
+        }
+        return true;
+    }
+};
+
+/**
+ * TextToBinary converts from file descriptor in to file descriptor out.
+ * */
+inline Result TextToBinary(int in, int out) {
+    return TextToBinary(FdReader{in}, FdWriter{out});
+}
+
+/**
+ * BinaryToText converts from file descriptor in to file descriptor out.
+ * */
+inline Result BinaryToText(int in, int out) {
+    return BinaryToText(FdReader{in}, FdWriter{out});
+}
+
+#endif // ULID_HAS_FD
+
+};  // namespace stream
+
+};  // namespace ulid
+
+#endif // ULID_STREAM_HH
@@ -1,16 +1,99 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <set>
+#include <sstream>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
-#ifdef ULIDUINT128
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#if defined(ULIDUINT128)
 #include "ulid_uint128.hh"
+#elif defined(ULIDU64PAIR)
+#include "ulid_u64pair.hh"
 #else
 #include "ulid_struct.hh"
 #endif // ULIDUINT128
 
-TEST(basic, 1) {
-	ulid::ULID ulid = ulid::Create(std::time(nullptr), []() { return 4; });
-	std::string str = ulid::Marshal(ulid);
+// the first header included picks ulid::ULID, the rest add their representation
+#include "ulid_struct.hh"
+#include "ulid_u64pair.hh"
+#if defined(__SIZEOF_INT128__)
+#include "ulid_uint128.hh"
+#endif
+
+namespace core = ulid::core;
+
+// the typed tests run once for every representation, through the core templates
+typedef ::testing::Types<
+#if defined(__SIZEOF_INT128__)
+	ulid::uint128::ULID,
+#endif
+	ulid::u64pair::ULID,
+	ulid::bytes::ULID> Representations;
+
+#define ULID_TYPED_SUITE(name) \
+	template <class T> \
+	class name : public ::testing::Test {}; \
+	TYPED_TEST_SUITE(name, Representations)
+
+ULID_TYPED_SUITE(basic);
+ULID_TYPED_SUITE(Create);
+ULID_TYPED_SUITE(EncodeTimeNow);
+ULID_TYPED_SUITE(EncodeTimeSystemClockNow);
+ULID_TYPED_SUITE(EncodeEntropyRand);
+ULID_TYPED_SUITE(EncodeEntropyMt19937);
+ULID_TYPED_SUITE(GenerateNow);
+ULID_TYPED_SUITE(EncodeEntropySecure);
+ULID_TYPED_SUITE(EncodeNowRand);
+ULID_TYPED_SUITE(CreateNowRand);
+ULID_TYPED_SUITE(GenerateBatch);
+ULID_TYPED_SUITE(MarshalTo);
+ULID_TYPED_SUITE(MarshalBatch);
+ULID_TYPED_SUITE(MarshalArray);
+ULID_TYPED_SUITE(MarshalHuman);
+ULID_TYPED_SUITE(MarshalBinary);
+ULID_TYPED_SUITE(MarshalBinaryArray);
+ULID_TYPED_SUITE(Unmarshal);
+ULID_TYPED_SUITE(TryUnmarshal);
+ULID_TYPED_SUITE(TryUnmarshalBatch);
+ULID_TYPED_SUITE(TryUnmarshalLines);
+ULID_TYPED_SUITE(UnmarshalBinary);
+ULID_TYPED_SUITE(Time);
+ULID_TYPED_SUITE(AlizainCompatibility);
+ULID_TYPED_SUITE(Constexpr);
+ULID_TYPED_SUITE(LexicographicalOrder);
+ULID_TYPED_SUITE(CompareULIDs);
+ULID_TYPED_SUITE(MinMaxULID);
+ULID_TYPED_SUITE(Sort);
+ULID_TYPED_SUITE(UlidIndex);
+ULID_TYPED_SUITE(MappedUlidFile);
+ULID_TYPED_SUITE(ExtractTimes);
+ULID_TYPED_SUITE(BucketCounts);
+ULID_TYPED_SUITE(MonotonicGenerator);
+ULID_TYPED_SUITE(PartitionedEntropy);
+ULID_TYPED_SUITE(PartitionedGenerator);
+ULID_TYPED_SUITE(IdDispenser);
+ULID_TYPED_SUITE(CounterGenerator);
+ULID_TYPED_SUITE(Hash);
+ULID_TYPED_SUITE(UlidFlatSet);
+ULID_TYPED_SUITE(UlidFlatMap);
+ULID_TYPED_SUITE(WindowedDeduper);
+
+
+TYPED_TEST(basic, 1) {
+	TypeParam ulid = core::Create<TypeParam>(std::time(nullptr), []() { return 4; });
+	std::string str = core::Marshal(ulid);
 
 	ASSERT_EQ(26, str.size());
 	for (char c : str) {
@@ -18,20 +101,74 @@ TEST(basic, 1) {
 	}
 }
 
-TEST(Create, 1) {
-	ulid::ULID ulid1 = 0;
-	ulid::Encode(1484581420, []() { return 4; }, ulid1);
+TYPED_TEST(Create, 1) {
+	TypeParam ulid1 = 0;
+	core::Encode(1484581420, []() { return 4; }, ulid1);
+
+	auto ulid2 = core::Create<TypeParam>(1484581420, []() { return 4; });
+
+	ASSERT_EQ(0, core::CompareULIDs(ulid1, ulid2));
+}
+
+TYPED_TEST(Create, 2) {
+	// the templated overloads match the std::function ones for byte callables
+	int i = 0;
+	std::function<uint8_t()> rng = [&i]() { return static_cast<uint8_t>(i++ * 37); };
+	TypeParam ulid1 = core::Create<TypeParam>(1484581420, rng);
+
+	int j = 0;
+	TypeParam ulid2 = core::Create<TypeParam>(1484581420, [&j]() { return static_cast<uint8_t>(j++ * 37); });
+
+	ASSERT_EQ(10, i);
+	ASSERT_EQ(10, j);
+	ASSERT_EQ(0, core::CompareULIDs(ulid1, ulid2));
+}
+
+struct CountingFill {
+	int calls = 0;
+
+	void fill(uint8_t* dst, size_t n) {
+		calls++;
+		for (size_t i = 0 ; i < n ; i++) {
+			dst[i] = static_cast<uint8_t>(i + 1);
+		}
+	}
+};
+
+TYPED_TEST(Create, 3) {
+	CountingFill fill;
+	TypeParam ulid = core::Create<TypeParam>(1484581420, fill);
+	ASSERT_EQ(1, fill.calls);
+
+	std::vector<uint8_t> b = core::MarshalBinary(ulid);
+	for (int i = 0 ; i < 10 ; i++) {
+		ASSERT_EQ(i + 1, b[6 + i]);
+	}
+}
+
+TYPED_TEST(Create, 4) {
+	// 64 bit generators are drawn twice, the first draw being the low 64 bits
+	std::mt19937_64 generator(4);
+	TypeParam ulid = core::Create<TypeParam>(1484581420, generator);
 
-	auto ulid2 = ulid::Create(1484581420, []() { return 4; });
+	std::mt19937_64 expected(4);
+	uint64_t lo = expected();
+	uint16_t hi = static_cast<uint16_t>(expected());
+	ASSERT_EQ(expected(), generator());
 
-	ASSERT_EQ(0, ulid::CompareULIDs(ulid1, ulid2));
+	std::vector<uint8_t> b = core::MarshalBinary(ulid);
+	ASSERT_EQ(hi, (b[6] << 8) | b[7]);
+	for (int i = 0 ; i < 8 ; i++) {
+		ASSERT_EQ(static_cast<uint8_t>(lo >> (56 - 8 * i)), b[8 + i]);
+	}
+	ASSERT_EQ(1484581420, core::Time(ulid));
 }
 
-TEST(EncodeTimeNow, 1) {
-	ulid::ULID ulid = 0;
-	ulid::EncodeTimeNow(ulid);
-	ulid::EncodeEntropy([]() { return 4; }, ulid);
-	std::string str = ulid::Marshal(ulid);
+TYPED_TEST(EncodeTimeNow, 1) {
+	TypeParam ulid = 0;
+	core::EncodeTimeNow(ulid);
+	core::EncodeEntropy([]() { return 4; }, ulid);
+	std::string str = core::Marshal(ulid);
 
 	ASSERT_EQ(26, str.size());
 	for (char c : str) {
@@ -39,11 +176,24 @@ TEST(EncodeTimeNow, 1) {
 	}
 }
 
-TEST(EncodeTimeSystemClockNow, 1) {
-	ulid::ULID ulid = 0;
-	ulid::EncodeTimeSystemClockNow(ulid);
-	ulid::EncodeEntropy([]() { return 4; }, ulid);
-	std::string str = ulid::Marshal(ulid);
+TYPED_TEST(EncodeTimeNow, 2) {
+	// millisecond resolution, not seconds stored as milliseconds
+	auto now = std::chrono::system_clock::now();
+	int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+
+	TypeParam ulid = 0;
+	core::EncodeTimeNow(ulid);
+	ASSERT_NEAR(ms, core::Time(ulid), 1000);
+
+	core::EncodeTimeNow(ulid::clocks::CoarseClock(), ulid);
+	ASSERT_NEAR(ms, core::Time(ulid), 1000);
+}
+
+TYPED_TEST(EncodeTimeSystemClockNow, 1) {
+	TypeParam ulid = 0;
+	core::EncodeTimeSystemClockNow(ulid);
+	core::EncodeEntropy([]() { return 4; }, ulid);
+	std::string str = core::Marshal(ulid);
 
 	ASSERT_EQ(26, str.size());
 	for (char c : str) {
@@ -51,11 +201,11 @@ TEST(EncodeTimeSystemClockNow, 1) {
 	}
 }
 
-TEST(EncodeEntropyRand, 1) {
-	ulid::ULID ulid = 0;
-	ulid::EncodeTimeNow(ulid);
-	ulid::EncodeEntropyRand(ulid);
-	std::string str = ulid::Marshal(ulid);
+TYPED_TEST(EncodeEntropyRand, 1) {
+	TypeParam ulid = 0;
+	core::EncodeTimeNow(ulid);
+	core::EncodeEntropyRand(ulid);
+	std::string str = core::Marshal(ulid);
 
 	ASSERT_EQ(26, str.size());
 	for (char c : str) {
@@ -63,55 +213,134 @@ TEST(EncodeEntropyRand, 1) {
 	}
 }
 
-TEST(EncodeEntropyRand, 2) {
+TYPED_TEST(EncodeEntropyRand, 2) {
 	time_t timestamp = 1000000;
 	auto duration = std::chrono::seconds(timestamp);
 	auto nsduration = std::chrono::duration_cast<std::chrono::nanoseconds>(duration);
 	auto msduration = std::chrono::duration_cast<std::chrono::milliseconds>(duration);
 
-	ulid::ULID ulid1 = 0;
-	ulid::EncodeTime(msduration.count(), ulid1);
+	TypeParam ulid1 = 0;
+	core::EncodeTime(msduration.count(), ulid1);
 
 	std::srand(nsduration.count());
-	ulid::EncodeEntropyRand(ulid1);
+	core::EncodeEntropyRand(ulid1);
 
-	ulid::ULID ulid2 = 0;
-	ulid::EncodeTime(msduration.count(), ulid2);
+	TypeParam ulid2 = 0;
+	core::EncodeTime(msduration.count(), ulid2);
 
 	std::srand(nsduration.count());
-	ulid::EncodeEntropyRand(ulid2);
+	core::EncodeEntropyRand(ulid2);
 
-	ASSERT_EQ(0, ulid::CompareULIDs(ulid1, ulid2));
+	ASSERT_EQ(0, core::CompareULIDs(ulid1, ulid2));
 }
 
-TEST(EncodeEntropyMt19937, 1) {
-	ulid::ULID ulid = 0;
-	ulid::EncodeTimeNow(ulid);
+TYPED_TEST(EncodeEntropyMt19937, 1) {
+	TypeParam ulid = 0;
+	core::EncodeTimeNow(ulid);
 
 	std::mt19937 generator(4);
-	ulid::EncodeEntropyMt19937(generator, ulid);
+	core::EncodeEntropyMt19937(generator, ulid);
 
-	std::string str = ulid::Marshal(ulid);
+	std::string str = core::Marshal(ulid);
 	ASSERT_EQ(26, str.size());
 	for (char c : str) {
 		ASSERT_NE(std::string::npos, std::string(ulid::Encoding).find(c));
 	}
 }
 
-TEST(EncodeNowRand, 1) {
-	ulid::ULID ulid = 0;
-	ulid::EncodeNowRand(ulid);
-	std::string str = ulid::Marshal(ulid);
+TYPED_TEST(EncodeEntropyMt19937, 2) {
+	ASSERT_EQ(16, sizeof(TypeParam));
+
+	TypeParam ulid1 = 0;
+	core::EncodeTime(1484581420, ulid1);
+	core::EncodeEntropyMt19937(ulid1);
+
+	TypeParam ulid2 = ulid1;
+	core::EncodeEntropyMt19937(ulid2);
+
+	ASSERT_EQ(1484581420, core::Time(ulid2));
+	ASSERT_NE(0, core::CompareULIDs(ulid1, ulid2));
+}
+
+TYPED_TEST(GenerateNow, 1) {
+	TypeParam ulid = 0;
+	core::GenerateNow(ulid);
+	std::string str = core::Marshal(ulid);
 
 	ASSERT_EQ(26, str.size());
 	for (char c : str) {
 		ASSERT_NE(std::string::npos, std::string(ulid::Encoding).find(c));
 	}
+
+	std::mt19937 generator(4);
+	TypeParam ulid1 = 0, ulid2 = 0;
+	core::GenerateNow(generator, ulid1);
+	generator.seed(4);
+	core::GenerateNow(generator, ulid2);
+	ASSERT_EQ(core::Marshal(ulid1).substr(10), core::Marshal(ulid2).substr(10));
+}
+
+TYPED_TEST(EncodeEntropySecure, 1) {
+	std::set<std::string> seen;
+	for (int i = 0 ; i < 1000 ; i++) {
+		TypeParam ulid = 0;
+		core::EncodeTime(1484581420, ulid);
+		core::EncodeEntropySecure(ulid);
+		ASSERT_EQ(1484581420, core::Time(ulid));
+		seen.insert(core::Marshal(ulid));
+	}
+	ASSERT_EQ(1000, seen.size());
+
+	std::vector<TypeParam> ulids(1000, 0);
+	core::GenerateBatch(ulid::entropy::SecureRandom(), ulids.data(), ulids.size());
+	for (auto& ulid : ulids) {
+		seen.insert(core::Marshal(ulid));
+	}
+	ASSERT_EQ(2000, seen.size());
 }
 
-TEST(CreateNowRand, 1) {
-	ulid::ULID ulid = ulid::CreateNowRand();
-	std::string str = ulid::Marshal(ulid);
+#if defined(__unix__) || defined(__APPLE__)
+TYPED_TEST(EncodeEntropySecure, 2) {
+	// a child must not hand out the bytes left in its parent's buffer
+	ulid::entropy::SecureRandom rng;
+	uint8_t warm[10];
+	rng.fill(warm, sizeof(warm));
+
+	int fds[2];
+	ASSERT_EQ(0, pipe(fds));
+
+	pid_t pid = fork();
+	ASSERT_NE(-1, pid);
+	if (pid == 0) {
+		uint8_t child[64];
+		rng.fill(child, sizeof(child));
+		ssize_t written = write(fds[1], child, sizeof(child));
+		_exit(written == sizeof(child) ? 0 : 1);
+	}
+
+	uint8_t parent[64], child[64];
+	rng.fill(parent, sizeof(parent));
+
+	size_t got = 0;
+	while (got < sizeof(child)) {
+		ssize_t r = read(fds[0], child + got, sizeof(child) - got);
+		ASSERT_GT(r, 0);
+		got += r;
+	}
+	int status = 0;
+	waitpid(pid, &status, 0);
+	close(fds[0]);
+	close(fds[1]);
+
+	ASSERT_EQ(0, status);
+	ASSERT_NE(0, std::memcmp(parent, child, sizeof(parent)));
+}
+#endif
+
+TYPED_TEST(EncodeNowRand, 1) {
+	TypeParam ulid = 0;
+	core::EncodeNowRand(ulid);
+	std::string str = core::Marshal(ulid);
 
 	ASSERT_EQ(26, str.size());
 	for (char c : str) {
@@ -119,54 +348,1789 @@ TEST(CreateNowRand, 1) {
 	}
 }
 
-TEST(MarshalBinary, 1) {
-	ulid::ULID ulid = ulid::Create(1484581420, []() { return 4; });
-	std::vector<uint8_t> b = ulid::MarshalBinary(ulid);
+TYPED_TEST(CreateNowRand, 1) {
+	TypeParam ulid = core::CreateNowRand<TypeParam>();
+	std::string str = core::Marshal(ulid);
 
-#ifdef ULIDUINT128
-	for (int i = 15 ; i >= 0 ; i--) {
-		ASSERT_EQ(static_cast<uint8_t>(ulid), b[i]);
-		ulid >>= 8;
+	ASSERT_EQ(26, str.size());
+	for (char c : str) {
+		ASSERT_NE(std::string::npos, std::string(ulid::Encoding).find(c));
 	}
-#else
-	for (int i = 0 ; i < 16 ; i++) {
-		ASSERT_EQ(ulid.data[i], b[i]);
+}
+
+TYPED_TEST(GenerateBatch, 1) {
+	std::vector<TypeParam> ulids(1000, 0);
+	time_t before = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+	core::GenerateBatch(ulids.data(), ulids.size());
+	time_t after = std::chrono::duration_cast<std::chrono::milliseconds>(
+		std::chrono::system_clock::now().time_since_epoch()).count();
+
+	std::set<std::string> seen;
+	for (auto& ulid : ulids) {
+		ASSERT_LE(before, core::Time(ulid));
+		ASSERT_GE(after, core::Time(ulid));
+		seen.insert(core::Marshal(ulid));
 	}
-#endif // ULIDUINT128
+	ASSERT_EQ(ulids.size(), seen.size());
+}
+
+TYPED_TEST(GenerateBatch, 2) {
+	// crosses a block boundary, the entropy only depends on the generator
+	std::mt19937 generator1(4), generator2(4);
+	std::vector<TypeParam> ulids1(300, 0), ulids2(300, 0);
+	core::GenerateBatch(generator1, ulids1.data(), ulids1.size());
+	core::GenerateBatch(generator2, ulids2.data(), ulids2.size());
+
+	for (size_t i = 0 ; i < ulids1.size() ; i++) {
+		ASSERT_EQ(core::Marshal(ulids1[i]).substr(10), core::Marshal(ulids2[i]).substr(10));
+		if (i > 0) {
+			ASSERT_NE(core::Marshal(ulids1[i - 1]).substr(10), core::Marshal(ulids1[i]).substr(10));
+		}
+	}
+}
+
+TYPED_TEST(MarshalTo, 1) {
+	// every value at every position
+	for (int i = 0 ; i < 26 ; i++) {
+		for (int v = 0 ; v < (i == 0 ? 8 : 32) ; v++) {
+			std::string str(26, '0');
+			str[i] = ulid::Encoding[v];
+			TypeParam ulid = core::Unmarshal<TypeParam>(str);
+
+			char scalar[26], dst[26];
+			core::MarshalToScalar(ulid, scalar);
+			core::MarshalTo(ulid, dst);
+			ASSERT_EQ(str, std::string(scalar, 26));
+			ASSERT_EQ(str, std::string(dst, 26));
+		}
+	}
+}
+
+TYPED_TEST(MarshalTo, 2) {
+	std::mt19937 generator(4);
+	for (int i = 0 ; i < 100000 ; i++) {
+		TypeParam ulid = 0;
+		core::EncodeTime((uint64_t(generator()) << 16) ^ generator(), ulid);
+		core::EncodeEntropyMt19937(generator, ulid);
+
+		char scalar[26], dst[26];
+		core::MarshalToScalar(ulid, scalar);
+		core::MarshalTo(ulid, dst);
+		ASSERT_EQ(std::string(scalar, 26), std::string(dst, 26));
+	}
+}
+
+TYPED_TEST(MarshalBatch, 1) {
+	std::mt19937 generator(4);
+	std::vector<TypeParam> ulids(67, 0);
+	for (auto& ulid : ulids) {
+		core::EncodeTime((uint64_t(generator()) << 16) ^ generator(), ulid);
+		core::EncodeEntropyMt19937(generator, ulid);
+	}
+
+	for (size_t n = 0 ; n <= ulids.size() ; n++) {
+		std::string dst(26 * n + 1, '#');
+		core::MarshalBatch(ulids.data(), n, &dst[0]);
+		ASSERT_EQ('#', dst[26 * n]);
+
+		for (size_t i = 0 ; i < n ; i++) {
+			char scalar[26];
+			core::MarshalToScalar(ulids[i], scalar);
+			ASSERT_EQ(std::string(scalar, 26), dst.substr(26 * i, 26));
+		}
+	}
+}
+
+TYPED_TEST(MarshalArray, 1) {
+	TypeParam ulid = core::Create<TypeParam>(1484581420, []() { return 4; });
+	std::array<char, 26> str = core::MarshalArray(ulid);
+	ASSERT_EQ("0001C7STHC0G2081040G208104", std::string(str.data(), str.size()));
+
+	std::ostringstream os;
+	using ulid::operator<<;
+	os << ulid << '\n';
+	ASSERT_EQ("0001C7STHC0G2081040G208104\n", os.str());
+
+	// __uint128_t is a builtin, only the class representations have formatters
+	if constexpr (std::is_class<TypeParam>::value) {
+#if defined(__cpp_lib_format)
+		ASSERT_EQ("id=0001C7STHC0G2081040G208104", std::format("id={}", ulid));
+#endif
+#if defined(ULID_WITH_FMT)
+		ASSERT_EQ("id=0001C7STHC0G2081040G208104", fmt::format("id={}", ulid));
+#endif
+	}
+}
+
+TYPED_TEST(MarshalHuman, 1) {
+	TypeParam ulid = core::Create<TypeParam>(1484581420, []() { return 4; });
+	ASSERT_EQ("19700118T042301420Z0G2081040G208104", core::MarshalHuman(ulid));
+	ASSERT_EQ(0, core::CompareULIDs(ulid, core::UnmarshalHuman<TypeParam>("19700118T042301420Z0G2081040G208104")));
+
+	struct {
+		time_t timestamp;
+		const char* human;
+	} cases[] = {
+		{0, "19700101T000000000Z"},
+		{1469918176385, "20160730T223616385Z"},
+		{951868799999, "20000229T235959999Z"},
+		{4107542400000, "21000301T000000000Z"},
+	};
+	for (auto& c : cases) {
+		TypeParam ulid = core::Create<TypeParam>(c.timestamp, []() { return 0xAB; });
+		std::string human = core::MarshalHuman(ulid);
+		ASSERT_EQ(35, human.size());
+		ASSERT_EQ(c.human, human.substr(0, 19));
+		ASSERT_EQ(core::Marshal(ulid).substr(10), human.substr(19));
+		ASSERT_EQ(0, core::CompareULIDs(ulid, core::UnmarshalHuman<TypeParam>(human)));
+	}
+}
+
+TYPED_TEST(MarshalHuman, 2) {
+	// every day for 500 years, at a varying time of day
+	std::mt19937 generator(4);
+	for (int64_t day = 0 ; day < 500 * 366 ; day++) {
+		time_t timestamp = day * 86400000 + generator() % 86400000;
+
+		TypeParam ulid = core::Create<TypeParam>(timestamp, generator);
+		ASSERT_EQ(0, core::CompareULIDs(ulid, core::UnmarshalHuman<TypeParam>(core::MarshalHuman(ulid))));
+	}
+}
+
+TYPED_TEST(MarshalBinary, 1) {
+	TypeParam ulid = core::Create<TypeParam>(1484581420, []() { return 4; });
+	std::vector<uint8_t> b = core::MarshalBinary(ulid);
+
+	// the bytes in memory are the big endian bytes, reversed for little endian representations
+	uint8_t want[16];
+	std::memcpy(want, &ulid, 16);
+	if (ulid::Storage<TypeParam>::LittleEndian) {
+		std::reverse(want, want + 16);
+	}
+	ASSERT_EQ(0, std::memcmp(want, b.data(), 16));
+}
+
+TYPED_TEST(MarshalBinaryArray, 1) {
+	TypeParam ulid = core::Create<TypeParam>(1484581420, []() { return 4; });
+	std::array<uint8_t, 16> b = core::MarshalBinaryArray(ulid);
+	std::vector<uint8_t> v = core::MarshalBinary(ulid);
+	ASSERT_TRUE(std::equal(b.begin(), b.end(), v.begin(), v.end()));
+
+	ASSERT_EQ(0, core::CompareULIDs(ulid, core::UnmarshalBinary<TypeParam>(b)));
+	ASSERT_EQ(0, core::CompareULIDs(ulid, core::UnmarshalBinary<TypeParam>(v)));
+	ASSERT_EQ(0, core::CompareULIDs(ulid, core::UnmarshalBinary<TypeParam>({0x00, 0x00, 0x58, 0x7c, 0xea, 0x2c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04})));
+#if __cplusplus >= 202002L
+	ASSERT_EQ(0, core::CompareULIDs(ulid, core::UnmarshalBinary<TypeParam>(std::span<const uint8_t, 16>(v.data(), 16))));
+#endif
+}
+
+TYPED_TEST(Unmarshal, 1) {
+	TypeParam ulid = core::Unmarshal<TypeParam>("0001C7STHC0G2081040G208104");
+	TypeParam ulid_expected = core::Create<TypeParam>(1484581420, []() { return 4; });
+	ASSERT_EQ(0, core::CompareULIDs(ulid_expected, ulid));
+}
+
+TYPED_TEST(Unmarshal, 2) {
+	// parse straight out of a larger buffer
+	std::string line = "id=0001C7STHC0G2081040G208104 ts=1484581420";
+	std::string_view view(line);
+	TypeParam ulid_expected = core::Create<TypeParam>(1484581420, []() { return 4; });
+
+	ASSERT_EQ(0, core::CompareULIDs(ulid_expected, core::Unmarshal<TypeParam>(view.substr(3, 26))));
+
+	TypeParam ulid = 0;
+	ASSERT_EQ(ulid::Status::OK, core::TryUnmarshal(view.substr(3, 26), ulid));
+	ASSERT_EQ(0, core::CompareULIDs(ulid_expected, ulid));
+	ASSERT_EQ(ulid::Status::InvalidLength, core::TryUnmarshal(view.substr(3, 27), ulid));
+}
+
+using namespace ulid::literals;
+
+constexpr ulid::ULID LiteralULID = "01ARZ3NDEKTSV4RRFFQ69G5FAV"_ulid;
+static_assert(ulid::Time(LiteralULID) == 1469922850259, "_ulid decodes at compile time");
+static_assert(ulid::ValidLiteral("7ZZZZZZZZZZZZZZZZZZZZZZZZZ", 26), "largest ULID");
+static_assert(!ulid::ValidLiteral("8ZZZZZZZZZZZZZZZZZZZZZZZZZ", 26), "overflow");
+static_assert(!ulid::ValidLiteral("01ARZ3NDEKTSV4RRFFQ69G5FA", 25), "too short");
+static_assert(!ulid::ValidLiteral("01ARZ3NDEKTSV4RRFFQ69G5FAU", 26), "U is not in the alphabet");
+
+template <class ULID>
+constexpr bool RoundTripsAtCompileTime(const char (&str)[27]) {
+	ULID ulid = 0;
+	core::UnmarshalFrom(str, ulid);
+	core::EncodeTime(core::Time(ulid), ulid);
+
+	std::array<char, 26> dst{};
+	core::MarshalTo(ulid, dst.data());
+	for (int i = 0 ; i < 26 ; i++) {
+		if (dst[i] != str[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+TEST(Literal, 1) {
+	ASSERT_EQ(0, ulid::CompareULIDs(ulid::Unmarshal("01ARZ3NDEKTSV4RRFFQ69G5FAV"), LiteralULID));
+	ASSERT_EQ("0001C7STHC0G2081040G208104", ulid::Marshal("0001C7STHC0G2081040G208104"_ulid));
+
+	// outside a constexpr context, still decoded (and checked) by the compiler
+	ulid::ULID runtime = "7ZZZZZZZZZZZZZZZZZZZZZZZZZ"_ulid;
+	ASSERT_EQ("7ZZZZZZZZZZZZZZZZZZZZZZZZZ", ulid::Marshal(runtime));
+}
+
+TYPED_TEST(Constexpr, 1) {
+	constexpr TypeParam literal = core::Literal<TypeParam>("01ARZ3NDEKTSV4RRFFQ69G5FAV", 26);
+	static_assert(core::Time(literal) == 1469922850259, "core::Literal decodes at compile time");
+	static_assert(RoundTripsAtCompileTime<TypeParam>("01ARZ3NDEKTSV4RRFFQ69G5FAV"), "constexpr MarshalTo and UnmarshalFrom");
+
+	ASSERT_EQ(0, core::CompareULIDs(core::Unmarshal<TypeParam>("01ARZ3NDEKTSV4RRFFQ69G5FAV"), literal));
 }
 
-TEST(Unmarshal, 1) {
-	ulid::ULID ulid = ulid::Unmarshal("0001C7STHC0G2081040G208104");
-	ulid::ULID ulid_expected = ulid::Create(1484581420, []() { return 4; });
-	ASSERT_EQ(0, ulid::CompareULIDs(ulid_expected, ulid));
+TYPED_TEST(TryUnmarshal, 1) {
+	TypeParam ulid_expected = core::Create<TypeParam>(1484581420, []() { return 4; });
+
+	TypeParam ulid = 0;
+	ASSERT_EQ(ulid::Status::OK, core::TryUnmarshal("0001C7STHC0G2081040G208104", ulid));
+	ASSERT_EQ(0, core::CompareULIDs(ulid_expected, ulid));
+
+	// lowercase and aliases
+	ulid = 0;
+	ASSERT_EQ(ulid::Status::OK, core::TryUnmarshal("ooo1c7sthcOg2O8iO4Og2o8lo4", ulid));
+	ASSERT_EQ(0, core::CompareULIDs(ulid_expected, ulid));
+
+	TypeParam max = 0;
+	ASSERT_EQ(ulid::Status::OK, core::TryUnmarshal("7ZZZZZZZZZZZZZZZZZZZZZZZZZ", max));
+	ASSERT_EQ("7ZZZZZZZZZZZZZZZZZZZZZZZZZ", core::Marshal(max));
 }
 
-TEST(UnmarshalBinary, 1) {
-	ulid::ULID ulid_expected = ulid::Create(1484581420, []() { return 4; });
-	std::vector<uint8_t> b = ulid::MarshalBinary(ulid_expected);
-	ulid::ULID ulid = ulid::UnmarshalBinary(b);
-	ASSERT_EQ(0, ulid::CompareULIDs(ulid_expected, ulid));
+TYPED_TEST(TryUnmarshal, 2) {
+	TypeParam ulid_expected = core::Create<TypeParam>(1484581420, []() { return 4; });
+	std::string valid = "0001C7STHC0G2081040G208104";
+
+	TypeParam ulid = ulid_expected;
+	ASSERT_EQ(ulid::Status::InvalidLength, core::TryUnmarshal(valid.substr(1), ulid));
+	ASSERT_EQ(ulid::Status::Overflow, core::TryUnmarshal("8001C7STHC0G2081040G208104", ulid));
+
+	for (size_t i = 0 ; i < valid.size() ; i++) {
+		for (char c : {'U', 'u', '!', ' ', '\0', '\n', '\x80', '\xFF', '[', '@', '`', '{', '/', ':'}) {
+			std::string str = valid;
+			str[i] = c;
+			ASSERT_EQ(ulid::Status::InvalidCharacter, core::TryUnmarshalFrom(str.data(), ulid));
+
+			char scalar[16];
+			ASSERT_EQ(ulid::Status::InvalidCharacter, ulid::base32::DecodeScalar<false>(str.data(), scalar));
+		}
+	}
+
+	// failures leave the ULID untouched
+	ASSERT_EQ(0, core::CompareULIDs(ulid_expected, ulid));
 }
 
-TEST(Time, 1) {
-	ulid::ULID ulid = ulid::Create(1484581420, []() { return 4; });
-	ASSERT_EQ(1484581420, ulid::Time(ulid));
+TYPED_TEST(TryUnmarshal, 3) {
+	// the vector kernel agrees with UnmarshalFrom and the scalar reference
+	std::mt19937 generator(4);
+	const std::string alphabet = std::string(ulid::Encoding) + "abcdefghjkmnpqrstvwxyzIiLlOo";
+	for (int i = 0 ; i < 100000 ; i++) {
+		std::string str(26, '0');
+		str[0] = "01234567"[generator() % 8];
+		for (int j = 1 ; j < 26 ; j++) {
+			str[j] = alphabet[generator() % alphabet.size()];
+		}
+
+		TypeParam ulid = 0;
+		ASSERT_EQ(ulid::Status::OK, core::TryUnmarshalFrom(str.data(), ulid));
+
+		uint8_t scalar[16], b[16];
+		ASSERT_EQ(ulid::Status::OK, ulid::base32::DecodeScalar<false>(str.data(), scalar));
+		core::MarshalBinaryTo(ulid, b);
+		ASSERT_EQ(0, std::memcmp(scalar, b, 16));
+
+		std::string upper = str;
+		for (char& c : upper) {
+			c = std::toupper(c);
+			c = c == 'I' || c == 'L' ? '1' : c == 'O' ? '0' : c;
+		}
+		ASSERT_EQ(upper, core::Marshal(ulid));
+		ASSERT_EQ(0, core::CompareULIDs(core::Unmarshal<TypeParam>(upper), ulid));
+	}
+}
+
+TYPED_TEST(TryUnmarshalBatch, 1) {
+	std::mt19937 generator(4);
+	std::vector<TypeParam> ulids(67, 0);
+	for (auto& ulid : ulids) {
+		core::EncodeTime((uint64_t(generator()) << 16) ^ generator(), ulid);
+		core::EncodeEntropyMt19937(generator, ulid);
+	}
+
+	for (size_t stride : {26, 27, 32}) {
+		std::string src(stride * ulids.size(), '\n');
+		for (size_t i = 0 ; i < ulids.size() ; i++) {
+			core::MarshalTo(ulids[i], &src[i * stride]);
+		}
+
+		std::vector<TypeParam> out(ulids.size(), 0);
+		ASSERT_EQ(ulids.size(), core::TryUnmarshalBatch(src.data(), ulids.size(), stride, out.data()));
+		for (size_t i = 0 ; i < ulids.size() ; i++) {
+			ASSERT_EQ(0, core::CompareULIDs(ulids[i], out[i]));
+		}
+
+		for (size_t bad : {0, 1, 40, 66}) {
+			std::string corrupt = src;
+			corrupt[bad * stride + 13] = 'U';
+			ASSERT_EQ(bad, core::TryUnmarshalBatch(corrupt.data(), ulids.size(), stride, out.data()));
+
+			corrupt = src;
+			corrupt[bad * stride] = '9';
+			ASSERT_EQ(bad, core::TryUnmarshalBatch(corrupt.data(), ulids.size(), stride, out.data()));
+		}
+	}
+}
+
+TYPED_TEST(TryUnmarshalLines, 1) {
+	std::string src =
+		"0001C7STHC0G2081040G208104\n"
+		"01ARYZ6S410000000000000000\r\n"
+		"01arz3ndektsv4rrffq69g5fav\n"
+		"0001C7STHC0G2081040G208104\n"
+		"7ZZZZZZZZZZZZZZZZZZZZZZZZZ";
+
+	TypeParam out[8];
+	size_t consumed = 0;
+	ASSERT_EQ(5, core::TryUnmarshalLines(src.data(), src.size(), out, 8, &consumed));
+	ASSERT_EQ(src.size(), consumed);
+	ASSERT_EQ("01ARYZ6S410000000000000000", core::Marshal(out[1]));
+	ASSERT_EQ("01ARZ3NDEKTSV4RRFFQ69G5FAV", core::Marshal(out[2]));
+	ASSERT_EQ("7ZZZZZZZZZZZZZZZZZZZZZZZZZ", core::Marshal(out[4]));
+
+	ASSERT_EQ(2, core::TryUnmarshalLines(src.data(), src.size(), out, 2, &consumed));
+	ASSERT_EQ(27 + 28, consumed);
+
+	std::string bad = src.substr(0, 27) + "0001C7STHC0G2081040G20810\n" + src.substr(27);
+	ASSERT_EQ(1, core::TryUnmarshalLines(bad.data(), bad.size(), out, 8, &consumed));
+	ASSERT_EQ(27, consumed);
+}
+
+TYPED_TEST(UnmarshalBinary, 1) {
+	TypeParam ulid_expected = core::Create<TypeParam>(1484581420, []() { return 4; });
+	std::vector<uint8_t> b = core::MarshalBinary(ulid_expected);
+	TypeParam ulid = core::UnmarshalBinary<TypeParam>(b);
+	ASSERT_EQ(0, core::CompareULIDs(ulid_expected, ulid));
+}
+
+TYPED_TEST(Time, 1) {
+	TypeParam ulid = core::Create<TypeParam>(1484581420, []() { return 4; });
+	ASSERT_EQ(1484581420, core::Time(ulid));
 }
 
 // https://github.com/oklog/ulid/blob/master/ulid_test.go#L160-L169
-TEST(AlizainCompatibility, 1) {
-	ulid::ULID ulid_got = 0;
-	ulid::EncodeTime(uint64_t(1469918176385), ulid_got);
+TYPED_TEST(AlizainCompatibility, 1) {
+	TypeParam ulid_got = 0;
+	core::EncodeTime(uint64_t(1469918176385), ulid_got);
 
-	ulid::ULID ulid_want = ulid::Unmarshal("01ARYZ6S410000000000000000");
-	ASSERT_EQ(0, ulid::CompareULIDs(ulid_want, ulid_got));
+	TypeParam ulid_want = core::Unmarshal<TypeParam>("01ARYZ6S410000000000000000");
+	ASSERT_EQ(0, core::CompareULIDs(ulid_want, ulid_got));
 }
 
-TEST(LexicographicalOrder, 1) {
-	ulid::ULID ulid1 = ulid::CreateNowRand();
+TYPED_TEST(LexicographicalOrder, 1) {
+	TypeParam ulid1 = core::CreateNowRand<TypeParam>();
 	std::this_thread::sleep_for(std::chrono::seconds(1));
-	ulid::ULID ulid2 = ulid::CreateNowRand();
+	TypeParam ulid2 = core::CreateNowRand<TypeParam>();
+
+	EXPECT_EQ(-1, core::CompareULIDs(ulid1, ulid2));
+	EXPECT_EQ(1, core::CompareULIDs(ulid2, ulid1));
+}
+
+TYPED_TEST(CompareULIDs, 1) {
+	std::mt19937 generator(4);
+	std::vector<TypeParam> ulids(1000);
+	core::GenerateBatch(generator, ulids.data(), ulids.size());
+	// shared prefixes of different lengths, down to a difference in the last byte
+	for (size_t i = 0 ; i < 100 ; i++) {
+		core::UnmarshalFrom(core::Marshal(ulids[i]).substr(0, 26 - i / 4).append(i / 4, '0').c_str(), ulids[i + 100]);
+	}
+
+	for (size_t i = 0 ; i < ulids.size() ; i++) {
+		for (size_t j = 0 ; j < ulids.size() ; j += 7) {
+			const TypeParam& a = ulids[i];
+			const TypeParam& b = ulids[j];
+
+			std::string sa = core::Marshal(a), sb = core::Marshal(b);
+			int want = (sa > sb) - (sa < sb);
+			ASSERT_EQ(want, core::CompareULIDs(a, b));
+
+			ASSERT_EQ(want < 0, a < b);
+			ASSERT_EQ(want > 0, a > b);
+			ASSERT_EQ(want <= 0, a <= b);
+			ASSERT_EQ(want >= 0, a >= b);
+			ASSERT_EQ(want == 0, a == b);
+			ASSERT_EQ(want != 0, a != b);
+#if __cplusplus >= 202002L
+			ASSERT_EQ(want < 0, (a <=> b) < 0);
+			ASSERT_EQ(want == 0, (a <=> b) == 0);
+#endif
+		}
+	}
+}
+
+TYPED_TEST(CompareULIDs, 2) {
+	std::vector<TypeParam> ulids(1000);
+	core::GenerateBatch(ulids.data(), ulids.size());
+
+	std::map<TypeParam, size_t> index;
+	for (size_t i = 0 ; i < ulids.size() ; i++) {
+		index[ulids[i]] = i;
+	}
+	ASSERT_EQ(1000, index.size());
+
+	std::sort(ulids.begin(), ulids.end());
+	size_t i = 0;
+	for (auto& kv : index) {
+		ASSERT_TRUE(kv.first == ulids[i++]);
+	}
+	ASSERT_TRUE(std::is_sorted(ulids.begin(), ulids.end(), [](const TypeParam& a, const TypeParam& b) {
+		return core::Marshal(a) < core::Marshal(b);
+	}));
+}
+
+TYPED_TEST(MinMaxULID, 1) {
+	ASSERT_EQ("01ARYZ6S410000000000000000", core::Marshal(core::MinULID<TypeParam>(1469918176385)));
+	ASSERT_EQ("01ARYZ6S41ZZZZZZZZZZZZZZZZ", core::Marshal(core::MaxULID<TypeParam>(1469918176385)));
+	ASSERT_EQ("00000000000000000000000000", core::Marshal(core::MinULID<TypeParam>(0)));
+	ASSERT_EQ("7ZZZZZZZZZZZZZZZZZZZZZZZZZ", core::Marshal(core::MaxULID<TypeParam>(281474976710655)));
+
+	std::mt19937 generator(7);
+	for (int i = 0 ; i < 1000 ; i++) {
+		TypeParam ulid = core::Create<TypeParam>(1469918176385, generator);
+		ASSERT_TRUE(core::MaxULID<TypeParam>(1469918176384) < core::MinULID<TypeParam>(1469918176385));
+		ASSERT_TRUE(core::MinULID<TypeParam>(1469918176385) <= ulid);
+		ASSERT_TRUE(ulid <= core::MaxULID<TypeParam>(1469918176385));
+		ASSERT_TRUE(core::MaxULID<TypeParam>(1469918176385) < core::MinULID<TypeParam>(1469918176386));
+	}
+
+	static_assert(core::Time(core::MaxULID<TypeParam>(1469918176385)) == 1469918176385, "");
+}
+
+TYPED_TEST(Sort, 1) {
+	// agrees with std::sort around the bucket and thread thresholds
+	std::mt19937 generator(4);
+	for (size_t n : {0, 1, 255, 256, 257, 5000, 70000, 300000}) {
+		std::vector<TypeParam> ulids(n, 0);
+		core::GenerateBatch(generator, ulids.data(), ulids.size());
+		for (size_t i = 0 ; i < n ; i++) {
+			core::EncodeTime(1484581420000 + generator() % 86400000, ulids[i]);
+		}
+
+		std::vector<TypeParam> want = ulids;
+		std::sort(want.begin(), want.end());
+
+		for (unsigned threads : {0, 1, 3}) {
+			std::vector<TypeParam> got = ulids;
+			core::Sort(got.data(), got.size(), threads);
+			ASSERT_TRUE(got == want) << "n=" << n << " threads=" << threads;
+		}
+	}
+}
+
+TYPED_TEST(Sort, 2) {
+	// shared prefixes, duplicates, and differences in the last byte only
+	std::mt19937 generator(4);
+	std::vector<TypeParam> ulids(200000, 0);
+	core::GenerateBatch(generator, ulids.data(), ulids.size());
+	for (size_t i = 0 ; i < ulids.size() ; i++) {
+		std::string str = core::Marshal(ulids[i]);
+		switch (i % 4) {
+		case 0:
+			// one millisecond
+			str.replace(0, 10, "0001C7STHC");
+			break;
+		case 1:
+			// all but the last character shared
+			str.replace(0, 25, "01ARZ3NDEKTSV4RRFFQ69G5FA");
+			break;
+		case 2:
+			// a few distinct values repeated
+			str = core::Marshal(ulids[generator() % 8]);
+			break;
+		}
+		core::UnmarshalFrom(str.c_str(), ulids[i]);
+	}
+
+	std::vector<TypeParam> want = ulids;
+	std::sort(want.begin(), want.end());
+
+	for (unsigned threads : {1, 4}) {
+		std::vector<TypeParam> got = ulids;
+		core::Sort(got.data(), got.size(), threads);
+		ASSERT_TRUE(got == want) << "threads=" << threads;
+
+		// a single millisecond
+		std::vector<TypeParam> ms(ulids.begin(), ulids.begin() + 1000);
+		for (auto& ulid : ms) {
+			core::EncodeTime(1484581420, ulid);
+		}
+		std::vector<TypeParam> ms_want = ms;
+		std::sort(ms_want.begin(), ms_want.end());
+		core::Sort(ms.data(), ms.size(), threads);
+		ASSERT_TRUE(ms == ms_want);
+	}
+
+	std::vector<TypeParam> same(100000, core::Unmarshal<TypeParam>("01ARZ3NDEKTSV4RRFFQ69G5FAV"));
+	core::Sort(same.data(), same.size(), 4);
+	ASSERT_TRUE(std::all_of(same.begin(), same.end(), [&](const TypeParam& ulid) { return ulid == same[0]; }));
+}
+
+TYPED_TEST(UlidIndex, 1) {
+	std::mt19937 generator(8);
+	for (size_t n : {0, 1, 7, 8, 9, 63, 64, 65, 1000, 70000}) {
+		// a few hundred milliseconds, with runs sharing the top 64 bits and duplicates
+		std::vector<TypeParam> ulids(n, 0);
+		core::GenerateBatch(generator, ulids.data(), ulids.size());
+		for (size_t i = 0 ; i < n ; i++) {
+			core::EncodeTime(1484581420000 + generator() % 300, ulids[i]);
+			if (i > 0 && i % 5 == 0) {
+				uint64_t lo = ulid::Storage<TypeParam>::Lo(ulids[i]);
+				ulid::Storage<TypeParam>::Set(ulids[i], ulid::Storage<TypeParam>::Hi(ulids[i - 1]), lo);
+			}
+			if (i > 0 && i % 7 == 0) {
+				ulids[i] = ulids[i - 1];
+			}
+		}
+		std::sort(ulids.begin(), ulids.end());
+
+		core::UlidIndex<TypeParam> index(ulids.data(), ulids.size());
+		ASSERT_EQ(n, index.Size());
+
+		std::vector<TypeParam> queries(ulids);
+		for (int i = 0 ; i < 200 ; i++) {
+			queries.push_back(core::Create<TypeParam>(1484581420000 - 1 + generator() % 302, generator));
+		}
+		for (size_t i = 0 ; i < n ; i += 3) {
+			// same top 64 bits as an element, entropy below and above it
+			uint64_t hi = ulid::Storage<TypeParam>::Hi(ulids[i]);
+			TypeParam q = 0;
+			ulid::Storage<TypeParam>::Set(q, hi, 0);
+			queries.push_back(q);
+			ulid::Storage<TypeParam>::Set(q, hi, ~uint64_t(0));
+			queries.push_back(q);
+		}
+		queries.push_back(core::MinULID<TypeParam>(0));
+		queries.push_back(core::MaxULID<TypeParam>(281474976710655));
+
+		for (const auto& q : queries) {
+			size_t lower = std::lower_bound(ulids.begin(), ulids.end(), q) - ulids.begin();
+			size_t upper = std::upper_bound(ulids.begin(), ulids.end(), q) - ulids.begin();
+			ASSERT_EQ(lower, index.LowerBound(q)) << "n=" << n << " " << core::Marshal(q);
+			ASSERT_EQ(upper, index.UpperBound(q)) << "n=" << n << " " << core::Marshal(q);
+			ASSERT_EQ(std::make_pair(lower, upper), index.EqualRange(q));
+		}
+
+		for (time_t t : {time_t(0), time_t(1484581420000 - 1), time_t(1484581420000), time_t(1484581420150),
+		                 time_t(1484581420299), time_t(1484581420300), time_t(281474976710655)}) {
+			size_t lower = std::lower_bound(ulids.begin(), ulids.end(), core::MinULID<TypeParam>(t)) - ulids.begin();
+			size_t upper = std::upper_bound(ulids.begin(), ulids.end(), core::MaxULID<TypeParam>(t)) - ulids.begin();
+			ASSERT_EQ(lower, index.LowerBoundTime(t)) << "n=" << n << " t=" << t;
+			ASSERT_EQ(upper, index.UpperBoundTime(t)) << "n=" << n << " t=" << t;
+		}
+
+		auto range = index.TimeRange(1484581420100, 1484581420199);
+		for (size_t i = 0 ; i < n ; i++) {
+			bool inside = core::Time(ulids[i]) >= 1484581420100 && core::Time(ulids[i]) <= 1484581420199;
+			ASSERT_EQ(inside, i >= range.first && i < range.second) << "n=" << n << " i=" << i;
+		}
+	}
+}
+
+TYPED_TEST(UlidIndex, 2) {
+	// full leaves under a partly filled inner node, queried above every key
+	for (size_t n : {8, 16, 72, 512, 4096, 8 * 9 * 8}) {
+		std::vector<TypeParam> ulids(n, 0);
+		for (size_t i = 0 ; i < n ; i++) {
+			ulids[i] = core::MinULID<TypeParam>(1000 + i);
+		}
+		core::UlidIndex<TypeParam> index(ulids.data(), ulids.size());
+
+		ASSERT_EQ(n, index.LowerBound(core::MaxULID<TypeParam>(1000000))) << "n=" << n;
+		ASSERT_EQ(n, index.UpperBound(core::MaxULID<TypeParam>(1000000))) << "n=" << n;
+		ASSERT_EQ(n, index.LowerBound(core::MaxULID<TypeParam>(281474976710655))) << "n=" << n;
+		ASSERT_EQ(n, index.LowerBoundTime(1000000)) << "n=" << n;
+		ASSERT_EQ(n, index.UpperBoundTime(1000 + n - 1)) << "n=" << n;
+		ASSERT_EQ(n - 1, index.LowerBound(ulids[n - 1])) << "n=" << n;
+		ASSERT_EQ(n, index.UpperBound(ulids[n - 1])) << "n=" << n;
+	}
+}
+
+#ifdef ULID_HAS_MMAP
+// WriteRecords writes ulids to a new temporary file with MarshalBinaryTo, and returns its path.
+template <class ULID>
+static std::string WriteRecords(const std::vector<ULID>& ulids, size_t extra = 0) {
+	char path[] = "/tmp/ulid_test_XXXXXX";
+	int fd = mkstemp(path);
+	std::vector<uint8_t> bytes(16 * ulids.size() + extra);
+	for (size_t i = 0 ; i < ulids.size() ; i++) {
+		core::MarshalBinaryTo(ulids[i], bytes.data() + 16 * i);
+	}
+	size_t written = 0;
+	while (fd >= 0 && written < bytes.size()) {
+		ssize_t w = write(fd, bytes.data() + written, bytes.size() - written);
+		if (w <= 0) {
+			break;
+		}
+		written += w;
+	}
+	close(fd);
+	return path;
+}
+
+TYPED_TEST(MappedUlidFile, 1) {
+	std::mt19937 generator(9);
+	std::vector<TypeParam> ulids(10000, 0);
+	core::GenerateBatch(generator, ulids.data(), ulids.size());
+	std::sort(ulids.begin(), ulids.end());
+	std::string path = WriteRecords(ulids);
+
+	core::MappedUlidFile<TypeParam> file;
+	ASSERT_TRUE(file.Open(path));
+	unlink(path.c_str());
+	ASSERT_TRUE(file.IsOpen());
+	ASSERT_EQ(ulids.size(), file.size());
+	ASSERT_TRUE(file.Advise(core::MappedUlidFile<TypeParam>::Sequential));
+	ASSERT_TRUE(std::equal(ulids.begin(), ulids.end(), file.begin(), file.end()));
+	ASSERT_TRUE(ulids.front() == file.front());
+	ASSERT_TRUE(ulids.back() == file.back());
+	ASSERT_TRUE(ulids[1234] == file[1234]);
+
+	ASSERT_TRUE(file.Advise(core::MappedUlidFile<TypeParam>::Random, 100, 3000));
+	for (size_t i = 0 ; i < ulids.size() ; i += 7) {
+		TypeParam q = core::Create<TypeParam>(core::Time(ulids[i]), generator);
+		ASSERT_EQ(std::lower_bound(ulids.begin(), ulids.end(), q) - ulids.begin(),
+		          std::lower_bound(file.begin(), file.end(), q) - file.begin());
+		ASSERT_EQ(std::upper_bound(ulids.begin(), ulids.end(), ulids[i]) - ulids.begin(),
+		          std::upper_bound(file.begin(), file.end(), ulids[i]) - file.begin());
+		ASSERT_EQ(size_t(std::lower_bound(ulids.begin(), ulids.end(), q) - ulids.begin()), file.LowerBound(q));
+		ASSERT_EQ(size_t(std::upper_bound(ulids.begin(), ulids.end(), ulids[i]) - ulids.begin()), file.UpperBound(ulids[i]));
+	}
+	ASSERT_EQ(0u, file.LowerBound(core::MinULID<TypeParam>(0)));
+	ASSERT_EQ(file.size(), file.UpperBound(core::MaxULID<TypeParam>(281474976710655)));
+
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 202002L
+	static_assert(std::random_access_iterator<typename core::MappedUlidFile<TypeParam>::const_iterator>);
+#endif
+
+	if constexpr (core::MappedUlidFile<TypeParam>::Native) {
+		core::UlidIndex<TypeParam> index(file.data(), file.size());
+		ASSERT_EQ(1234u, index.LowerBound(ulids[1234]));
+	}
+
+	core::MappedUlidFile<TypeParam> moved(std::move(file));
+	ASSERT_FALSE(file.IsOpen());
+	ASSERT_EQ(ulids.size(), moved.size());
+	moved.Close();
+	ASSERT_TRUE(moved.empty());
+	ASSERT_TRUE(moved.begin() == moved.end());
+}
+
+TYPED_TEST(MappedUlidFile, 2) {
+	core::MappedUlidFile<TypeParam> file;
+
+	std::string path = WriteRecords(std::vector<TypeParam>());
+	ASSERT_TRUE(file.Open(path));
+	unlink(path.c_str());
+	ASSERT_TRUE(file.empty());
+	ASSERT_TRUE(file.Advise(core::MappedUlidFile<TypeParam>::WillNeed));
+
+	// a partial record
+	path = WriteRecords(std::vector<TypeParam>(3, 0), 5);
+	errno = 0;
+	ASSERT_FALSE(file.Open(path));
+	ASSERT_EQ(EINVAL, errno);
+	unlink(path.c_str());
+
+	errno = 0;
+	ASSERT_FALSE(file.Open("/nonexistent/ulids.bin"));
+	ASSERT_EQ(ENOENT, errno);
+	ASSERT_FALSE(file.IsOpen());
+}
+#endif
+
+TYPED_TEST(ExtractTimes, 1) {
+	std::mt19937 generator(5);
+	std::vector<TypeParam> ulids(1000, 0);
+	core::GenerateBatch(generator, ulids.data(), ulids.size());
+	ulids[0] = core::Unmarshal<TypeParam>("7ZZZZZZZZZZZZZZZZZZZZZZZZZ");
+	ulids[1] = core::Unmarshal<TypeParam>("00000000000000000000000000");
+	for (size_t i = 2 ; i < ulids.size() ; i++) {
+		core::EncodeTime(static_cast<time_t>((uint64_t(generator()) << 16) ^ generator()), ulids[i]);
+	}
+
+	// every length, for the vector loops and their scalar tails
+	for (size_t n = 0 ; n <= 37 ; n++) {
+		std::vector<int64_t> times(n + 1, -1);
+		core::ExtractTimes(ulids.data(), n, times.data());
+		for (size_t i = 0 ; i < n ; i++) {
+			ASSERT_EQ(core::Time(ulids[i]), times[i]) << "n=" << n << " i=" << i;
+		}
+		ASSERT_EQ(-1, times[n]);
+	}
+
+	std::vector<int64_t> times(ulids.size());
+	core::ExtractTimes(ulids.data(), ulids.size(), times.data());
+	ASSERT_EQ(281474976710655, times[0]);
+	ASSERT_EQ(0, times[1]);
+	for (size_t i = 0 ; i < ulids.size() ; i++) {
+		ASSERT_EQ(core::Time(ulids[i]), times[i]);
+	}
+}
+
+TYPED_TEST(BucketCounts, 1) {
+	std::mt19937 generator(6);
+	std::vector<TypeParam> ulids(5000, 0);
+	core::GenerateBatch(generator, ulids.data(), ulids.size());
+	for (auto& ulid : ulids) {
+		core::EncodeTime(1484581420000 + generator() % 86400000 - 3600000, ulid);
+	}
+
+	struct Case {
+		int64_t bucket_ms;
+		int64_t start_ms;
+		size_t buckets;
+	};
+	const Case cases[] = {
+		{1, 1484581420000, 100000},
+		{7, 1484581420000, 1000},
+		{1000, 1484581420000, 3600},
+		{3600000, 1484581420000, 24},
+		{86400000, 0, 20000},
+		// spans past 2^52, divided exactly
+		{int64_t(1) << 30, 0, 1 << 23},
+		{int64_t(1) << 62, -(int64_t(1) << 62), 5},
+	};
+	for (const Case& c : cases) {
+		std::vector<uint64_t> want(c.buckets, 1);
+		size_t counted = 0;
+		for (const auto& ulid : ulids) {
+			int64_t x = core::Time(ulid) - c.start_ms;
+			if (x >= 0 && static_cast<uint64_t>(x / c.bucket_ms) < c.buckets) {
+				want[x / c.bucket_ms]++;
+				counted++;
+			}
+		}
+
+		// counts are added to, not overwritten
+		std::vector<uint64_t> got(c.buckets, 1);
+		ASSERT_EQ(counted, core::BucketCounts(ulids.data(), ulids.size(), c.bucket_ms, c.start_ms, got.data(), c.buckets));
+		ASSERT_TRUE(got == want) << "bucket_ms=" << c.bucket_ms;
+	}
+
+	// every timestamp on a bucket boundary and either side of it
+	std::vector<TypeParam> edges;
+	for (int64_t t = 1484581420000 - 10 ; t <= 1484581420000 + 10 * 9 + 10 ; t++) {
+		edges.push_back(core::Create<TypeParam>(t, []() { return 4; }));
+	}
+	std::vector<uint64_t> got(10, 0);
+	ASSERT_EQ(90u, core::BucketCounts(edges.data(), edges.size(), 9, 1484581420000, got.data(), got.size()));
+	ASSERT_TRUE(std::all_of(got.begin(), got.end(), [](uint64_t c) { return c == 9; }));
+}
+
+// MemoryReader hands out src at most chunk bytes per read, to land line and
+// record boundaries across reads.
+struct MemoryReader {
+	const std::string& src;
+	size_t chunk;
+	size_t pos = 0;
+
+	ptrdiff_t operator()(void* dst, size_t n) {
+		n = std::min({n, chunk, src.size() - pos});
+		std::memcpy(dst, src.data() + pos, n);
+		pos += n;
+		return static_cast<ptrdiff_t>(n);
+	}
+};
+
+// MemoryWriter appends to dst.
+struct MemoryWriter {
+	std::string& dst;
+
+	bool operator()(const void* src, size_t n) {
+		dst.append(static_cast<const char*>(src), n);
+		return true;
+	}
+};
+
+TEST(Stream, 1) {
+	std::mt19937 generator(11);
+	std::string records, text;
+	for (int i = 0 ; i < 200000 ; i++) {
+		ulid::ULID id = ulid::Create(static_cast<time_t>(generator()) << 8, generator);
+		uint8_t record[16];
+		ulid::MarshalBinaryTo(id, record);
+		records.append(reinterpret_cast<const char*>(record), 16);
+		text += ulid::Marshal(id) + "\n";
+	}
+
+	for (size_t chunk : {size_t(1) << 30, size_t(4096), size_t(27), size_t(7)}) {
+		std::string binary, lines;
+		ulid::stream::Result result = ulid::stream::TextToBinary(MemoryReader{text, chunk}, MemoryWriter{binary});
+		ASSERT_TRUE(result.ok()) << "chunk=" << chunk;
+		ASSERT_EQ(records.size() / 16, result.count);
+		ASSERT_TRUE(binary == records) << "chunk=" << chunk;
+
+		result = ulid::stream::BinaryToText(MemoryReader{records, chunk}, MemoryWriter{lines});
+		ASSERT_TRUE(result.ok()) << "chunk=" << chunk;
+		ASSERT_EQ(records.size() / 16, result.count);
+		ASSERT_TRUE(lines == text) << "chunk=" << chunk;
+
+		if (chunk < 100) {
+			// the rest is the same at every size, only the boundaries matter
+			text.resize(27 * 5000);
+			records.resize(16 * 5000);
+		}
+	}
+}
+
+TEST(Stream, 2) {
+	// "\r\n" line endings, and no newline at the end
+	std::string text = "01ARZ3NDEKTSV4RRFFQ69G5FAV\r\n7ZZZZZZZZZZZZZZZZZZZZZZZZZ\r\n00000000000000000000000000";
+	std::string binary;
+	ulid::stream::Result result = ulid::stream::TextToBinary(MemoryReader{text, 5}, MemoryWriter{binary});
+	ASSERT_TRUE(result.ok());
+	ASSERT_EQ(3u, result.count);
+	ASSERT_EQ(48u, binary.size());
+	ASSERT_EQ("01ARZ3NDEKTSV4RRFFQ69G5FAV", ulid::Marshal(ulid::UnmarshalBinary(*reinterpret_cast<const uint8_t(*)[16]>(binary.data()))));
+
+	std::string lines;
+	result = ulid::stream::BinaryToText(MemoryReader{binary, 1 << 20}, MemoryWriter{lines});
+	ASSERT_TRUE(result.ok());
+	ASSERT_EQ("01ARZ3NDEKTSV4RRFFQ69G5FAV\n7ZZZZZZZZZZZZZZZZZZZZZZZZZ\n00000000000000000000000000\n", lines);
+
+	std::string empty, out;
+	result = ulid::stream::TextToBinary(MemoryReader{empty, 1}, MemoryWriter{out});
+	ASSERT_TRUE(result.ok());
+	ASSERT_EQ(0u, result.count);
+	result = ulid::stream::BinaryToText(MemoryReader{empty, 1}, MemoryWriter{out});
+	ASSERT_TRUE(result.ok());
+	ASSERT_TRUE(out.empty());
+}
+
+TEST(Stream, 3) {
+	// the first bad line stops the conversion, after the lines before it
+	const std::string good = "01ARZ3NDEKTSV4RRFFQ69G5FAV\n";
+	const std::pair<std::string, ulid::Status> bad[] = {
+		{"01ARZ3NDEKTSV4RRFFQ69G5FA\n", ulid::Status::InvalidLength},
+		{"01ARZ3NDEKTSV4RRFFQ69G5FAVV\n", ulid::Status::InvalidLength},
+		{"\n", ulid::Status::InvalidLength},
+		{"01ARZ3NDEKTSV4RRFFQ69G5FAU\n", ulid::Status::InvalidCharacter},
+		{"81ARZ3NDEKTSV4RRFFQ69G5FAV\n", ulid::Status::Overflow},
+		{"01ARZ3NDEKTSV4RRFFQ69G5FA", ulid::Status::InvalidLength},
+	};
+	for (const auto& b : bad) {
+		for (size_t before : {0, 1, 70000}) {
+			std::string text;
+			for (size_t i = 0 ; i < before ; i++) {
+				text += good;
+			}
+			text += b.first + good;
+
+			std::string binary;
+			ulid::stream::Result result = ulid::stream::TextToBinary(MemoryReader{text, 100000}, MemoryWriter{binary});
+			ASSERT_FALSE(result.ok()) << b.first;
+			ASSERT_EQ(b.second, result.status) << b.first;
+			ASSERT_EQ(0, result.error);
+			ASSERT_EQ(before, result.count) << b.first;
+			ASSERT_EQ(16 * before, binary.size());
+		}
+	}
+
+	// a whole buffer without a newline
+	std::string text(ulid::stream::LineSize * ulid::stream::Block + 1, '0'), binary;
+	ASSERT_EQ(ulid::Status::InvalidLength, ulid::stream::TextToBinary(MemoryReader{text, 1 << 30}, MemoryWriter{binary}).status);
+}
+
+TEST(Stream, 4) {
+	// a trailing partial record is reported after the whole ones are written
+	std::string records(16 * 3 + 5, '\0'), lines;
+	ulid::stream::Result result = ulid::stream::BinaryToText(MemoryReader{records, 16}, MemoryWriter{lines});
+	ASSERT_EQ(ulid::Status::InvalidLength, result.status);
+	ASSERT_EQ(3u, result.count);
+	ASSERT_EQ(3 * ulid::stream::LineSize, lines.size());
+
+	// failures of the callbacks come back as errors
+	std::string text = "01ARZ3NDEKTSV4RRFFQ69G5FAV\n";
+	result = ulid::stream::TextToBinary(MemoryReader{text, 100}, [](const void*, size_t) {
+		errno = ENOSPC;
+		return false;
+	});
+	ASSERT_FALSE(result.ok());
+	ASSERT_EQ(ENOSPC, result.error);
+	result = ulid::stream::BinaryToText([](void*, size_t) -> ptrdiff_t {
+		errno = EIO;
+		return -1;
+	}, MemoryWriter{lines});
+	ASSERT_EQ(EIO, result.error);
+}
+
+TYPED_TEST(MonotonicGenerator, 1) {
+	core::MonotonicGenerator<TypeParam> gen;
+
+	TypeParam prev = 0;
+	ASSERT_TRUE(gen.Next(1484581420, prev));
+	for (int i = 0 ; i < 1000 ; i++) {
+		TypeParam next = 0;
+		ASSERT_TRUE(gen.Next(1484581420, next));
+		ASSERT_EQ(1484581420, core::Time(next));
+		ASSERT_EQ(-1, core::CompareULIDs(prev, next));
+		prev = next;
+	}
+
+	// the clock stepping backwards keeps the last timestamp
+	TypeParam next = 0;
+	ASSERT_TRUE(gen.Next(1484581419, next));
+	ASSERT_EQ(1484581420, core::Time(next));
+	ASSERT_EQ(-1, core::CompareULIDs(prev, next));
+}
+
+TYPED_TEST(MonotonicGenerator, 2) {
+	core::MonotonicGenerator<TypeParam> gen;
+
+	// all 0xFF entropy leaves no room for an increment within the millisecond
+	TypeParam ulid = 0;
+	ASSERT_TRUE(gen.Next(1484581520, []() { return 0xFF; }, ulid));
+	ASSERT_EQ("0001C7STMG", core::Marshal(ulid).substr(0, 10));
+	ASSERT_EQ("ZZZZZZZZZZZZZZZZ", core::Marshal(ulid).substr(10));
+
+	TypeParam overflow = ulid;
+	ASSERT_FALSE(gen.Next(1484581520, []() { return 0xFF; }, overflow));
+	ASSERT_EQ(0, core::CompareULIDs(ulid, overflow));
+
+	ASSERT_TRUE(gen.Next(1484581521, []() { return 0xFF; }, ulid));
+	ASSERT_EQ(1484581521, core::Time(ulid));
+}
+
+TYPED_TEST(MonotonicGenerator, 5) {
+	core::MonotonicGenerator<TypeParam> gen;
+
+	// the increment carries out of the low 64 bits of entropy
+	int calls = 0;
+	TypeParam ulid = 0;
+	ASSERT_TRUE(gen.Next(1484581620, [&calls]() { return calls++ < 2 ? 0x00 : 0xFF; }, ulid));
+	ASSERT_EQ("000FZZZZZZZZZZZZ", core::Marshal(ulid).substr(10));
+
+	ASSERT_TRUE(gen.Next(1484581620, ulid));
+	ASSERT_EQ(1484581620, core::Time(ulid));
+	ASSERT_EQ("000G000000000000", core::Marshal(ulid).substr(10));
+}
+
+TYPED_TEST(MonotonicGenerator, 6) {
+	core::MonotonicGenerator<TypeParam> gen1, gen2;
+
+	// each generator has its own last ULID, a timestamp ahead on one does not hold back the other
+	TypeParam ulid = 0;
+	ASSERT_TRUE(gen1.Next(1484581820, ulid));
+	ASSERT_TRUE(gen2.Next(1484581720, ulid));
+	ASSERT_EQ(1484581720, core::Time(ulid));
+	ASSERT_TRUE(gen1.Next(1484581720, ulid));
+	ASSERT_EQ(1484581820, core::Time(ulid));
+}
+
+TYPED_TEST(MonotonicGenerator, 7) {
+	core::MonotonicGenerator<TypeParam> gen;
+
+	// a generator passed directly draws the same entropy as Create with it
+	std::mt19937_64 rng(4), want_rng(4);
+	TypeParam ulid = 0;
+	ASSERT_TRUE(gen.Next(1484581920, rng, ulid));
+	ASSERT_EQ(0, core::CompareULIDs(core::Create<TypeParam>(1484581920, want_rng), ulid));
+
+	TypeParam next = 0;
+	ASSERT_TRUE(gen.Next(1484581920, rng, next));
+	ASSERT_EQ(-1, core::CompareULIDs(ulid, next));
+}
+
+struct ManualClock {
+	int64_t* now;
+
+	int64_t Now() {
+		return *now;
+	}
+};
+
+TYPED_TEST(MonotonicGenerator, 4) {
+	int64_t now = 1484581420;
+	core::BasicMonotonicGenerator<TypeParam, ManualClock> gen(ManualClock{&now});
+
+	TypeParam prev = 0;
+	ASSERT_TRUE(gen.Next(prev));
+	ASSERT_EQ(1484581420, core::Time(prev));
+
+	// a step back of an hour keeps handing out IDs after the last one
+	now -= 3600 * 1000;
+	for (int i = 0 ; i < 100 ; i++) {
+		TypeParam next = 0;
+		ASSERT_TRUE(gen.Next(next));
+		ASSERT_EQ(1484581420, core::Time(next));
+		ASSERT_EQ(-1, core::CompareULIDs(prev, next));
+		prev = next;
+	}
+
+	now = 1484581421;
+	TypeParam next = 0;
+	ASSERT_TRUE(gen.Next(next));
+	ASSERT_EQ(1484581421, core::Time(next));
+	ASSERT_EQ(-1, core::CompareULIDs(prev, next));
+}
+
+TYPED_TEST(MonotonicGenerator, 3) {
+	core::MonotonicGenerator<TypeParam> gen;
+
+	std::vector<std::vector<TypeParam>> out(4);
+	std::vector<std::thread> threads;
+	for (auto& ids : out) {
+		threads.emplace_back([&gen, &ids]() {
+			for (int i = 0 ; i < 10000 ; i++) {
+				TypeParam ulid = 0;
+				if (gen.Next(ulid)) {
+					ids.push_back(ulid);
+				}
+			}
+		});
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	std::set<std::string> all;
+	for (auto& ids : out) {
+		ASSERT_EQ(10000, ids.size());
+		for (size_t i = 1 ; i < ids.size() ; i++) {
+			ASSERT_EQ(-1, core::CompareULIDs(ids[i - 1], ids[i]));
+		}
+		for (auto& ulid : ids) {
+			all.insert(core::Marshal(ulid));
+		}
+	}
+	ASSERT_EQ(40000, all.size());
+}
+
+TYPED_TEST(PartitionedEntropy, 1) {
+	std::mt19937_64 generator(12);
+	// fields inside either word, across the two, and full width
+	const core::EntropyLayout layouts[] = {{0, 0}, {8, 8}, {16, 0}, {20, 12}, {24, 16}, {64, 16}, {0, 16}, {44, 16}};
+	for (const auto& layout : layouts) {
+		ASSERT_TRUE(layout.Valid());
+		for (int i = 0 ; i < 1000 ; i++) {
+			const uint64_t node = generator() & layout.MaxNode(), sequence = generator() & layout.MaxSequence();
+			TypeParam ulid = core::Create<TypeParam>(1484581420, generator);
+			core::EncodePartitionedEntropy(layout, node, sequence, generator, ulid);
+
+			ASSERT_EQ(1484581420, core::Time(ulid));
+			ASSERT_EQ(node, core::ExtractNode(layout, ulid)) << layout.node_bits << " " << layout.sequence_bits;
+			ASSERT_EQ(sequence, core::ExtractSequence(layout, ulid)) << layout.node_bits << " " << layout.sequence_bits;
+
+			// the random bits below them are separate
+			const int random = std::min(64, layout.RandomBits());
+			core::partition::SetField(ulid, 0, random, ~core::partition::Field(ulid, 0, random));
+			ASSERT_EQ(1484581420, core::Time(ulid));
+			ASSERT_EQ(node, core::ExtractNode(layout, ulid));
+			ASSERT_EQ(sequence, core::ExtractSequence(layout, ulid));
+		}
+	}
+
+	// the node is the top of the entropy, right after the timestamp
+	TypeParam ulid = 0;
+	core::EncodeTime(0, ulid);
+	core::EncodePartitionedEntropy(core::EntropyLayout{10, 0}, 0x3FF, 0, generator, ulid);
+	ASSERT_EQ("0000000000ZZ", core::Marshal(ulid).substr(0, 12));
+
+	ASSERT_FALSE((core::EntropyLayout{65, 0}.Valid()));
+	ASSERT_FALSE((core::EntropyLayout{64, 17}.Valid()));
+	ASSERT_FALSE((core::EntropyLayout{-1, 0}.Valid()));
+}
+
+TYPED_TEST(PartitionedGenerator, 1) {
+	std::mt19937 generator(13);
+	core::PartitionedGenerator<TypeParam> gen(core::EntropyLayout{12, 4}, 0xABC);
+
+	// the sequence counts up within a millisecond, then runs out
+	TypeParam prev = 0;
+	for (uint64_t i = 0 ; i < 16 ; i++) {
+		TypeParam ulid = 0;
+		ASSERT_TRUE(gen.Next(1484581420, generator, ulid));
+		ASSERT_EQ(1484581420, core::Time(ulid));
+		ASSERT_EQ(0xABCu, core::ExtractNode(gen.Layout(), ulid));
+		ASSERT_EQ(i, core::ExtractSequence(gen.Layout(), ulid));
+		if (i > 0) {
+			ASSERT_EQ(-1, core::CompareULIDs(prev, ulid));
+		}
+		prev = ulid;
+	}
+	TypeParam untouched = 0;
+	ASSERT_FALSE(gen.Next(1484581420, generator, untouched));
+	ASSERT_TRUE(untouched == 0);
+
+	// a step back stays in the last millisecond
+	ASSERT_FALSE(gen.Next(1484581419, generator, untouched));
+
+	// and the next one starts over
+	TypeParam ulid = 0;
+	ASSERT_TRUE(gen.Next(1484581421, generator, ulid));
+	ASSERT_EQ(1484581421, core::Time(ulid));
+	ASSERT_EQ(0u, core::ExtractSequence(gen.Layout(), ulid));
+	ASSERT_TRUE(gen.Next(1484581420, generator, ulid));
+	ASSERT_EQ(1484581421, core::Time(ulid));
+	ASSERT_EQ(1u, core::ExtractSequence(gen.Layout(), ulid));
+
+	// with no sequence bits, one per millisecond
+	core::PartitionedGenerator<TypeParam> single(core::EntropyLayout{16, 0}, 7);
+	ASSERT_TRUE(single.Next(1484581420, ulid));
+	ASSERT_FALSE(single.Next(1484581420, ulid));
+	ASSERT_TRUE(single.Next(1484581421, ulid));
+
+	// nothing from a layout that does not hold the node
+	core::PartitionedGenerator<TypeParam> small(core::EntropyLayout{4, 4}, 16);
+	ASSERT_FALSE(small.Next(ulid));
+	core::PartitionedGenerator<TypeParam> invalid(core::EntropyLayout{64, 17}, 0);
+	ASSERT_FALSE(invalid.Next(ulid));
+}
+
+TYPED_TEST(PartitionedGenerator, 2) {
+	// nodes drawing the same "random" bits in the same milliseconds still never collide
+	const core::EntropyLayout layout{8, 16};
+	std::vector<core::PartitionedGenerator<TypeParam>> nodes;
+	std::vector<TypeParam> out;
+	std::set<std::string> all;
+	for (uint64_t node = 0 ; node < 4 ; node++) {
+		core::PartitionedGenerator<TypeParam> gen(layout, node);
+		std::mt19937 generator(14);
+		for (int i = 0 ; i < 3000 ; i++) {
+			TypeParam ulid = 0;
+			ASSERT_TRUE(gen.Next(1484581420 + i / 1000, generator, ulid));
+			ASSERT_EQ(node, core::ExtractNode(layout, ulid));
+			all.insert(core::Marshal(ulid));
+		}
+	}
+	ASSERT_EQ(12000u, all.size());
+
+	// one generator shared by threads
+	core::PartitionedGenerator<TypeParam> gen(layout, 3);
+	std::vector<std::vector<TypeParam>> ids(4);
+	std::vector<std::thread> threads;
+	for (auto& v : ids) {
+		threads.emplace_back([&gen, &v]() {
+			for (int i = 0 ; i < 10000 ; i++) {
+				TypeParam ulid = 0;
+				if (gen.Next(ulid)) {
+					v.push_back(ulid);
+				}
+			}
+		});
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+	all.clear();
+	for (auto& v : ids) {
+		ASSERT_EQ(10000u, v.size());
+		for (size_t i = 1 ; i < v.size() ; i++) {
+			ASSERT_EQ(-1, core::CompareULIDs(v[i - 1], v[i]));
+		}
+		for (auto& ulid : v) {
+			all.insert(core::Marshal(ulid));
+		}
+	}
+	ASSERT_EQ(40000u, all.size());
+}
+
+TEST(Counter, 1) {
+	// the known answers of the Random123 reference
+	uint32_t zero[4] = {0, 0, 0, 0};
+	ulid::counter::Philox4x32(zero, 0);
+	ASSERT_EQ(0x6627e8d5u, zero[0]);
+	ASSERT_EQ(0xe169c58du, zero[1]);
+	ASSERT_EQ(0xbc57ac4cu, zero[2]);
+	ASSERT_EQ(0x9b00dbd8u, zero[3]);
+
+	uint32_t ones[4] = {0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF};
+	ulid::counter::Philox4x32(ones, ~uint64_t(0));
+	ASSERT_EQ(0x408f276du, ones[0]);
+	ASSERT_EQ(0x41c83b0eu, ones[1]);
+	ASSERT_EQ(0xa20bc7c6u, ones[2]);
+	ASSERT_EQ(0x6d5451fdu, ones[3]);
+
+	uint32_t pi[4] = {0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344};
+	ulid::counter::Philox4x32(pi, 0x299f31d0a4093822ull);
+	ASSERT_EQ(0xd16cfe09u, pi[0]);
+	ASSERT_EQ(0x94fdccebu, pi[1]);
+	ASSERT_EQ(0x5001e420u, pi[2]);
+	ASSERT_EQ(0x24126ea1u, pi[3]);
+}
+
+TEST(Counter, 2) {
+	// the batch kernel matches one at a time, at any offset and length, across
+	// the carry into the high word of the counter
+	const uint64_t starts[] = {0, 5, 1000, 0xFFFFFFFF - 3, ~uint64_t(0) - 20};
+	for (uint64_t start : starts) {
+		for (size_t n : {0, 1, 7, 8, 9, 33}) {
+			std::vector<uint16_t> hi(n);
+			std::vector<uint64_t> lo(n);
+			ulid::counter::EntropyBatch(42, 7, start, n, hi.data(), lo.data());
+			for (size_t i = 0 ; i < n ; i++) {
+				uint16_t h;
+				uint64_t l;
+				ulid::counter::Entropy(42, 7, start + i, h, l);
+				ASSERT_EQ(h, hi[i]) << start << " " << i;
+				ASSERT_EQ(l, lo[i]) << start << " " << i;
+			}
+		}
+	}
+}
+
+TYPED_TEST(CounterGenerator, 1) {
+	core::CounterGenerator<TypeParam> gen(42, 3, 1484581420, 10);
+	std::vector<TypeParam> all(1000);
+	gen.FillAt(0, all.data(), all.size());
+
+	for (size_t i = 0 ; i < all.size() ; i++) {
+		TypeParam ulid = 0;
+		gen.At(i, ulid);
+		ASSERT_EQ(core::Marshal(ulid), core::Marshal(all[i])) << i;
+		ASSERT_EQ(1484581420 + static_cast<time_t>(i / 10), core::Time(all[i])) << i;
+	}
+
+	// Next and Fill walk the same sequence
+	for (size_t i = 0 ; i < 100 ; i++) {
+		TypeParam ulid = 0;
+		gen.Next(ulid);
+		ASSERT_EQ(core::Marshal(all[i]), core::Marshal(ulid));
+	}
+	std::vector<TypeParam> rest(900);
+	gen.Fill(rest.data(), rest.size());
+	for (size_t i = 0 ; i < rest.size() ; i++) {
+		ASSERT_EQ(core::Marshal(all[100 + i]), core::Marshal(rest[i]));
+	}
+	ASSERT_EQ(1000u, gen.Position());
+
+	// jumping ahead
+	TypeParam ulid = 0;
+	gen.Seek(517);
+	gen.Next(ulid);
+	ASSERT_EQ(core::Marshal(all[517]), core::Marshal(ulid));
+	gen.Discard(100);
+	gen.Next(ulid);
+	ASSERT_EQ(core::Marshal(all[618]), core::Marshal(ulid));
+
+	// a batch starting mid millisecond
+	std::vector<TypeParam> mid(300);
+	gen.FillAt(15, mid.data(), mid.size());
+	for (size_t i = 0 ; i < mid.size() ; i++) {
+		ASSERT_EQ(core::Marshal(all[15 + i]), core::Marshal(mid[i]));
+	}
+
+	// another generator with the same parameters agrees, other streams and seeds do not
+	core::CounterGenerator<TypeParam> same(42, 3, 1484581420, 10), stream(42, 4, 1484581420, 10), seed(43, 3, 1484581420, 10);
+	std::set<std::string> distinct;
+	for (size_t i = 0 ; i < all.size() ; i++) {
+		TypeParam a = 0, b = 0, c = 0;
+		same.Next(a);
+		stream.Next(b);
+		seed.Next(c);
+		ASSERT_EQ(core::Marshal(all[i]), core::Marshal(a));
+		distinct.insert(core::Marshal(a));
+		distinct.insert(core::Marshal(b));
+		distinct.insert(core::Marshal(c));
+	}
+	ASSERT_EQ(3000u, distinct.size());
+}
+
+TYPED_TEST(CounterGenerator, 2) {
+	// however the work is split between threads the ULIDs are the same
+	const size_t n = 100000;
+	core::CounterGenerator<TypeParam> shared(7, 0, 1484581420, 1000);
+	std::vector<TypeParam> expected(n);
+	shared.FillAt(0, expected.data(), n);
+
+	for (size_t threads : {2, 3, 8}) {
+		std::vector<TypeParam> got(n);
+		std::vector<std::thread> workers;
+		for (size_t t = 0 ; t < threads ; t++) {
+			workers.emplace_back([&got, t, threads, n]() {
+				const size_t first = n * t / threads, last = n * (t + 1) / threads;
+				core::CounterGenerator<TypeParam> gen(7, 0, 1484581420, 1000);
+				gen.Seek(first);
+				for (size_t i = first ; i < last ; i++) {
+					gen.Next(got[i]);
+				}
+			});
+		}
+		for (auto& w : workers) {
+			w.join();
+		}
+		for (size_t i = 0 ; i < n ; i++) {
+			ASSERT_EQ(core::Marshal(expected[i]), core::Marshal(got[i])) << threads << " " << i;
+		}
+	}
+}
+
+TYPED_TEST(Hash, 1) {
+	core::Hash<TypeParam> hash;
+	std::mt19937 generator(15);
+
+	// random ULIDs, and ULIDs with no entropy a millisecond apart, spread over the low and high bits
+	std::vector<TypeParam> random, sequential;
+	for (int i = 0 ; i < 4096 ; i++) {
+		random.push_back(core::Create<TypeParam>(1484581420 + i / 16, generator));
+		sequential.push_back(core::MinULID<TypeParam>(1484581420 + i));
+	}
+	for (const auto* ulids : {&random, &sequential}) {
+		std::set<size_t> hashes, low, high;
+		for (const auto& ulid : *ulids) {
+			const size_t h = hash(ulid);
+			hashes.insert(h);
+			low.insert(h & 0x3FF);
+			high.insert(h >> (8 * sizeof(size_t) - 10));
+		}
+		ASSERT_EQ(4096u, hashes.size());
+		ASSERT_GT(low.size(), 900u);
+		ASSERT_GT(high.size(), 900u);
+	}
+
+	TypeParam copy = random[7];
+	ASSERT_EQ(hash(random[7]), hash(copy));
+}
+
+TEST(Hash, 2) {
+	// the class type representations work with the standard containers
+	std::unordered_set<ulid::u64pair::ULID> pairs;
+	std::unordered_map<ulid::bytes::ULID, int> bytes;
+	std::unordered_set<ulid::uint128::ULID, ulid::core::Hash<ulid::uint128::ULID>> ints;
+	std::mt19937 generator(16);
+	for (int i = 0 ; i < 1000 ; i++) {
+		pairs.insert(ulid::core::Create<ulid::u64pair::ULID>(1484581420, generator));
+		bytes[ulid::core::Create<ulid::bytes::ULID>(1484581420, generator)] = i;
+		ints.insert(ulid::core::Create<ulid::uint128::ULID>(1484581420, generator));
+	}
+	ASSERT_EQ(1000u, pairs.size());
+	ASSERT_EQ(1000u, bytes.size());
+	ASSERT_EQ(1000u, ints.size());
+	ASSERT_EQ(std::hash<ulid::u64pair::ULID>()(*pairs.begin()), ulid::core::Hash<ulid::u64pair::ULID>()(*pairs.begin()));
+}
+
+TYPED_TEST(UlidFlatSet, 1) {
+	std::mt19937 generator(17);
+	core::UlidFlatSet<TypeParam> set;
+	std::set<std::string> reference;
+	ASSERT_TRUE(set.empty());
+	ASSERT_FALSE(set.contains(TypeParam(1)));
+	ASSERT_TRUE(set.find(TypeParam(1)) == set.end());
+	ASSERT_EQ(0u, set.erase(TypeParam(1)));
+
+	std::vector<TypeParam> ulids;
+	for (int i = 0 ; i < 20000 ; i++) {
+		// a few repeats, and runs with no entropy
+		TypeParam ulid = i % 10 == 0 ? core::MinULID<TypeParam>(1484581420 + i) : core::Create<TypeParam>(1484581420, generator);
+		if (i % 7 == 0 && !ulids.empty()) {
+			ulid = ulids[generator() % ulids.size()];
+		}
+		ulids.push_back(ulid);
+		auto inserted = set.insert(ulid);
+		ASSERT_EQ(reference.insert(core::Marshal(ulid)).second, inserted.second);
+		ASSERT_TRUE(*inserted.first == ulid);
+	}
+	ASSERT_EQ(reference.size(), set.size());
+	ASSERT_LE(set.size(), set.capacity() - set.capacity() / 8);
+
+	for (const auto& ulid : ulids) {
+		ASSERT_TRUE(set.contains(ulid));
+		ASSERT_TRUE(*set.find(ulid) == ulid);
+	}
+	for (int i = 0 ; i < 1000 ; i++) {
+		ASSERT_FALSE(set.contains(core::Create<TypeParam>(1484581421, generator)));
+	}
+
+	// iteration visits every ULID once
+	size_t visited = 0;
+	for (const auto& ulid : set) {
+		ASSERT_EQ(1u, reference.count(core::Marshal(ulid)));
+		visited++;
+	}
+	ASSERT_EQ(set.size(), visited);
+
+	// erase half, through the key and through iterators
+	for (size_t i = 0 ; i < ulids.size() ; i += 2) {
+		const bool there = reference.erase(core::Marshal(ulids[i])) == 1;
+		ASSERT_EQ(there ? 1u : 0u, set.erase(ulids[i]));
+	}
+	ASSERT_EQ(reference.size(), set.size());
+	for (auto it = set.begin() ; it != set.end() ; ) {
+		if (core::Time(*it) % 3 == 0) {
+			reference.erase(core::Marshal(*it));
+			it = set.erase(it);
+		} else {
+			++it;
+		}
+	}
+	ASSERT_EQ(reference.size(), set.size());
+	for (const auto& ulid : ulids) {
+		ASSERT_EQ(reference.count(core::Marshal(ulid)) == 1, set.contains(ulid));
+	}
+
+	// copies and moves
+	core::UlidFlatSet<TypeParam> copy(set);
+	ASSERT_EQ(set.size(), copy.size());
+	for (const auto& ulid : set) {
+		ASSERT_TRUE(copy.contains(ulid));
+	}
+	core::UlidFlatSet<TypeParam> moved(std::move(copy));
+	ASSERT_EQ(set.size(), moved.size());
+	ASSERT_TRUE(copy.empty());
+	copy = moved;
+	ASSERT_EQ(set.size(), copy.size());
+
+	const size_t capacity = set.capacity();
+	set.clear();
+	ASSERT_TRUE(set.empty());
+	ASSERT_EQ(capacity, set.capacity());
+	ASSERT_FALSE(set.contains(ulids[1]));
+	ASSERT_TRUE(set.begin() == set.end());
+}
+
+TYPED_TEST(UlidFlatSet, 2) {
+	// inserting and erasing over and over reuses the tombstones, the table does not grow
+	std::mt19937 generator(18);
+	core::UlidFlatSet<TypeParam> set(1000);
+	const size_t capacity = set.capacity();
+	ASSERT_GE(capacity - capacity / 8, 1000u);
+
+	std::deque<TypeParam> live;
+	for (int i = 0 ; i < 100000 ; i++) {
+		TypeParam ulid = core::Create<TypeParam>(1484581420 + i, generator);
+		ASSERT_TRUE(set.insert(ulid).second);
+		live.push_back(ulid);
+		if (live.size() > 500) {
+			ASSERT_EQ(1u, set.erase(live.front()));
+			live.pop_front();
+		}
+	}
+	ASSERT_EQ(500u, set.size());
+	ASSERT_EQ(capacity, set.capacity());
+	for (const auto& ulid : live) {
+		ASSERT_TRUE(set.contains(ulid));
+	}
+}
+
+TYPED_TEST(UlidFlatMap, 1) {
+	std::mt19937 generator(19);
+	core::UlidFlatMap<TypeParam, std::string> map;
+	std::vector<TypeParam> ulids;
+	for (int i = 0 ; i < 5000 ; i++) {
+		ulids.push_back(core::Create<TypeParam>(1484581420 + i, generator));
+		map[ulids.back()] = std::to_string(i);
+	}
+	ASSERT_EQ(5000u, map.size());
+	for (int i = 0 ; i < 5000 ; i++) {
+		auto it = map.find(ulids[i]);
+		ASSERT_TRUE(it != map.end());
+		ASSERT_EQ(std::to_string(i), it->second);
+	}
+
+	// try_emplace and insert leave an existing value alone
+	ASSERT_FALSE(map.try_emplace(ulids[3], "x").second);
+	ASSERT_FALSE(map.insert({ulids[4], "y"}).second);
+	ASSERT_EQ("3", map[ulids[3]]);
+	ASSERT_EQ("4", map[ulids[4]]);
+	TypeParam fresh = core::Create<TypeParam>(1484581419, generator);
+	ASSERT_TRUE(map.try_emplace(fresh, 3, 'z').second);
+	ASSERT_EQ("zzz", map[fresh]);
+
+	// a missing ULID is added value initialized
+	core::UlidFlatMap<TypeParam, int> counts;
+	for (int i = 0 ; i < 1000 ; i++) {
+		counts[ulids[i % 100]]++;
+	}
+	ASSERT_EQ(100u, counts.size());
+	for (const auto& entry : counts) {
+		ASSERT_EQ(10, entry.second);
+	}
+
+	for (int i = 0 ; i < 5000 ; i += 2) {
+		ASSERT_EQ(1u, map.erase(ulids[i]));
+	}
+	ASSERT_EQ(2501u, map.size());
+	ASSERT_EQ("4999", map.find(ulids[4999])->second);
+}
+
+TYPED_TEST(WindowedDeduper, 1) {
+	std::mt19937 generator(20);
+	core::WindowedDeduper<TypeParam> dedup(1000, 100);
+	ASSERT_EQ(10u, dedup.Buckets());
+	ASSERT_EQ(0, dedup.WindowStart());
+
+	const TypeParam a = core::Create<TypeParam>(1484581420000, generator);
+	const TypeParam b = core::Create<TypeParam>(1484581420000, generator);
+	ASSERT_TRUE(dedup.insert_if_absent(a));
+	ASSERT_FALSE(dedup.insert_if_absent(a));
+	ASSERT_TRUE(dedup.insert_if_absent(b));
+	ASSERT_TRUE(dedup.contains(a));
+	ASSERT_EQ(2u, dedup.size());
+
+	// a batch, with replays of earlier ULIDs and within itself
+	std::vector<TypeParam> batch;
+	for (int i = 0 ; i < 100 ; i++) {
+		batch.push_back(core::Create<TypeParam>(1484581420000 + i, generator));
+	}
+	batch.push_back(a);
+	batch.push_back(batch[5]);
+	bool fresh[102];
+	ASSERT_EQ(100u, dedup.insert_if_absent(batch.data(), batch.size(), fresh));
+	for (int i = 0 ; i < 100 ; i++) {
+		ASSERT_TRUE(fresh[i]);
+	}
+	ASSERT_FALSE(fresh[100]);
+	ASSERT_FALSE(fresh[101]);
+	ASSERT_EQ(0u, dedup.insert_if_absent(batch.data(), batch.size(), nullptr));
+	ASSERT_EQ(102u, dedup.size());
+
+	// moving on a window drops the old buckets, their ULIDs are late
+	ASSERT_EQ(1484581419100, dedup.WindowStart());
+	dedup.Advance(1484581421050);
+	ASSERT_EQ(1484581420100, dedup.WindowStart());
+	ASSERT_EQ(0u, dedup.size());
+	ASSERT_FALSE(dedup.contains(a));
+	ASSERT_FALSE(dedup.insert_if_absent(core::Create<TypeParam>(1484581420099, generator)));
+	ASSERT_EQ(1u, dedup.Late());
+	ASSERT_TRUE(dedup.insert_if_absent(core::Create<TypeParam>(1484581420100, generator)));
+
+	// Advance never moves back
+	dedup.Advance(0);
+	ASSERT_EQ(1484581420100, dedup.WindowStart());
+}
+
+TYPED_TEST(WindowedDeduper, 2) {
+	// a stream with replays and stragglers, against a plain set of the ULIDs
+	// of the buckets in the window
+	std::mt19937 generator(21);
+	const int64_t bucket_ms = 50;
+	const int64_t buckets = 8;
+	core::WindowedDeduper<TypeParam> dedup(400, bucket_ms);
+
+	std::map<std::string, int64_t> seen;
+	std::vector<TypeParam> sent;
+	int64_t newest = -1, now = 1484581420000;
+	uint64_t late = 0;
+	for (int i = 0 ; i < 50000 ; i++) {
+		now += generator() % 3;
+		TypeParam ulid;
+		switch (generator() % 10) {
+		case 0:
+			// a replay of something recent, or not so recent
+			ulid = sent.empty() ? core::Create<TypeParam>(now, generator) :
+			       sent[sent.size() - 1 - generator() % std::min<size_t>(sent.size(), 2000)];
+			break;
+		case 1:
+			// created a while ago
+			ulid = core::Create<TypeParam>(now - static_cast<int64_t>(generator() % 600), generator);
+			break;
+		default:
+			ulid = core::Create<TypeParam>(now, generator);
+		}
+		sent.push_back(ulid);
+
+		const int64_t bucket = static_cast<int64_t>(core::Time(ulid)) / bucket_ms;
+		bool expected;
+		if (bucket > newest) {
+			newest = bucket;
+			for (auto it = seen.begin() ; it != seen.end() ; ) {
+				it = newest - it->second >= buckets ? seen.erase(it) : std::next(it);
+			}
+		}
+		if (newest - bucket >= buckets) {
+			expected = false;
+			late++;
+		} else {
+			expected = seen.emplace(core::Marshal(ulid), bucket).second;
+		}
+
+		ASSERT_EQ(expected, dedup.insert_if_absent(ulid)) << i;
+		if (i % 1000 == 0) {
+			ASSERT_EQ(seen.size(), dedup.size());
+		}
+	}
+	ASSERT_EQ(late, dedup.Late());
+	ASSERT_GT(late, 0u);
+}
+
+TYPED_TEST(WindowedDeduper, 3) {
+	// under a steady rate the memory stops growing once the window has filled
+	core::WindowedDeduper<TypeParam> dedup(100);
+	core::CounterGenerator<TypeParam> gen(22, 0, 1484581420000, 100);
+	std::vector<TypeParam> block(1000);
+
+	size_t filled = 0;
+	for (int i = 0 ; i < 200 ; i++) {
+		gen.Fill(block.data(), block.size());
+		ASSERT_EQ(block.size(), dedup.insert_if_absent(block.data(), block.size(), nullptr));
+		ASSERT_LE(dedup.size(), 100u * 100u + 1000u);
+		if (i == 50) {
+			filled = dedup.AllocatedBytes();
+		}
+	}
+	ASSERT_EQ(filled, dedup.AllocatedBytes());
+}
+
+// AtomicClock is a ManualClock safe to read from the dispenser's thread.
+struct AtomicClock {
+	std::atomic<int64_t>* now;
+
+	int64_t Now() {
+		return now->load();
+	}
+};
+
+// WaitAvailable waits up to a second for the dispenser to hold n ULIDs.
+template <class Dispenser>
+static bool WaitAvailable(const Dispenser& dispenser, size_t n) {
+	for (int i = 0 ; i < 1000 && dispenser.Available() < n ; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return dispenser.Available() >= n;
+}
+
+TYPED_TEST(IdDispenser, 1) {
+	std::atomic<int64_t> now(1484581420000);
+	core::BasicIdDispenser<TypeParam, AtomicClock> dispenser(1000, 100, AtomicClock{&now});
+	ASSERT_EQ(1000u, dispenser.HighWater());
+	ASSERT_TRUE(WaitAvailable(dispenser, 1000));
+	ASSERT_EQ(1000u, dispenser.Available());
+
+	// it stops at the high water mark
+	std::this_thread::sleep_for(std::chrono::milliseconds(60));
+	ASSERT_EQ(1000u, dispenser.Available());
+
+	// and tops up once below half, which may happen while they are being taken
+	std::set<std::string> seen;
+	TypeParam ulid = 0;
+	for (int i = 0 ; i < 600 ; i++) {
+		ASSERT_TRUE(dispenser.TryNext(ulid));
+		ASSERT_EQ(1484581420000, core::Time(ulid));
+		seen.insert(core::Marshal(ulid));
+	}
+	ASSERT_TRUE(WaitAvailable(dispenser, 500));
+	ASSERT_LE(dispenser.Available(), 1000u);
+
+	// drained, it refills again
+	for (int i = 0 ; i < 100000 && dispenser.TryNext(ulid) ; i++) {
+		seen.insert(core::Marshal(ulid));
+	}
+	ASSERT_TRUE(WaitAvailable(dispenser, 500));
+	ASSERT_LE(dispenser.Available(), 1000u);
+
+	const size_t taken = seen.size();
+	for (int i = 0 ; i < 5000 ; i++) {
+		seen.insert(core::Marshal(dispenser.Next()));
+	}
+	ASSERT_EQ(taken + 5000, seen.size());
+}
+
+TYPED_TEST(IdDispenser, 2) {
+	std::atomic<int64_t> now(1484581420000);
+	core::BasicIdDispenser<TypeParam, AtomicClock> dispenser(512, 40, AtomicClock{&now});
+	ASSERT_TRUE(WaitAvailable(dispenser, 512));
+
+	// once the clock moves on, the old ULIDs are thrown away instead of handed out
+	now += 1000;
+	for (int i = 0 ; i < 1000 ; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		TypeParam ulid = 0;
+		if (dispenser.Available() == 512 && dispenser.TryNext(ulid) && core::Time(ulid) == now.load()) {
+			break;
+		}
+	}
+	for (int i = 0 ; i < 2000 ; i++) {
+		ASSERT_EQ(1484581421000, core::Time(dispenser.Next()));
+	}
+
+	// run dry, Next mints inline from the same clock
+	now += 1000;
+	for (int i = 0 ; i < 100000 ; i++) {
+		TypeParam ulid = dispenser.Next();
+		ASSERT_GE(core::Time(ulid), 1484581421000);
+	}
+}
+
+TYPED_TEST(IdDispenser, 3) {
+	core::IdDispenser<TypeParam> dispenser(4096);
+
+	std::vector<std::vector<TypeParam>> out(4);
+	std::vector<std::thread> threads;
+	for (auto& ids : out) {
+		threads.emplace_back([&dispenser, &ids]() {
+			for (int i = 0 ; i < 20000 ; i++) {
+				ids.push_back(dispenser.Next());
+			}
+		});
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+
+	const int64_t now = ulid::clocks::DefaultClock().Now();
+	std::set<std::string> all;
+	for (auto& ids : out) {
+		for (auto& ulid : ids) {
+			ASSERT_NEAR(now, core::Time(ulid), 1000);
+			all.insert(core::Marshal(ulid));
+		}
+	}
+	ASSERT_EQ(80000u, all.size());
+}
+
+TEST(Clocks, 1) {
+	int64_t ms = ulid::clocks::SystemClock().Now();
+
+	ASSERT_NEAR(ms, ulid::clocks::RealtimeClock().Now(), 100);
+	ASSERT_NEAR(ms, ulid::clocks::CoarseClock().Now(), 100);
+	ASSERT_NEAR(ms, ulid::clocks::TscClock<>().Now(), 100);
+
+	// calibrated, the counter tracks the wall clock
+	ulid::clocks::TscClock<> tsc;
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	for (int i = 0 ; i < 10 ; i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(15));
+		ASSERT_NEAR(ulid::clocks::RealtimeClock().NowNs(), tsc.NowNs(), 5000000);
+	}
+}
+
+struct SteppedClock {
+	static int64_t offset;
+
+	int64_t NowNs() {
+		return ulid::clocks::RealtimeClock().NowNs() + offset;
+	}
+};
+
+int64_t SteppedClock::offset = 0;
+
+TEST(Clocks, 2) {
+	const int64_t hour = int64_t(3600) * 1000000000;
+	const int64_t resync = ulid::clocks::TscClock<SteppedClock>::ResyncNs;
+
+	ulid::clocks::TscClock<SteppedClock> tsc;
+	tsc.NowNs();
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	tsc.NowNs();
+
+	// the wall clock steps back, the TSC clock follows within a resync interval
+	SteppedClock::offset = -hour;
+	std::this_thread::sleep_for(std::chrono::nanoseconds(resync + 10000000));
+	ASSERT_NEAR(SteppedClock().NowNs(), tsc.NowNs(), 5000000);
+
+	// and the step did not disturb the calibration
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	ASSERT_NEAR(SteppedClock().NowNs(), tsc.NowNs(), 5000000);
 
-	EXPECT_EQ(-1, ulid::CompareULIDs(ulid1, ulid2));
-	EXPECT_EQ(1, ulid::CompareULIDs(ulid2, ulid1));
+	SteppedClock::offset = 0;
+	std::this_thread::sleep_for(std::chrono::nanoseconds(resync + 10000000));
+	ASSERT_NEAR(SteppedClock().NowNs(), tsc.NowNs(), 5000000);
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	ASSERT_NEAR(SteppedClock().NowNs(), tsc.NowNs(), 5000000);
 }
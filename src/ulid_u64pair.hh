@@ -0,0 +1,117 @@
+#ifndef ULID_U64PAIR_HH
+#define ULID_U64PAIR_HH
+
+#include <cstdint>
+#include <ctime>
+#include <type_traits>
+
+#include "ulid_core.hh"
+
+namespace ulid {
+
+namespace u64pair {
+
+/**
+ * ULID is a 16 byte Universally Unique Lexicographically Sortable Identifier
+ *
+ * It is held as two host order 64 bit words: hi is the 48 bit timestamp followed
+ * by the top 16 bits of entropy, lo the remaining 64 bits of entropy. Every
+ * operation works on whole words, like the __uint128_t version, without needing
+ * a compiler with 128 bit integers.
+ *
+ * The words are laid out like a __uint128_t on the host (lo first on little
+ * endian machines), so the vector kernels in ulid_base32.hh read it in place.
+ * */
+struct alignas(16) ULID : core::Operators<ULID> {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    uint64_t hi = 0;
+    uint64_t lo = 0;
+#else
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+#endif
+
+    ULID() = default;
+
+    constexpr ULID(uint64_t val) : lo(val) {}
+};
+
+static_assert(sizeof(ULID) == 16, "ULID must be exactly 16 bytes");
+static_assert(alignof(ULID) == 16, "ULID must be 16 byte aligned");
+static_assert(std::is_trivially_copyable<ULID>::value, "ULID must be trivially copyable");
+static_assert(std::is_standard_layout<ULID>::value, "ULID must be standard layout");
+
+};  // namespace u64pair
+
+/**
+ * Storage for a pair of 64 bit words, the words are the members and the bytes
+ * are two byte swapped loads or stores.
+ * */
+template <>
+struct Storage<u64pair::ULID> {
+    static constexpr bool LittleEndian = base32::HostLittleEndian;
+
+    static constexpr uint64_t Hi(const u64pair::ULID& ulid) {
+        return ulid.hi;
+    }
+
+    static constexpr uint64_t Lo(const u64pair::ULID& ulid) {
+        return ulid.lo;
+    }
+
+    static constexpr void Set(u64pair::ULID& ulid, uint64_t hi, uint64_t lo) {
+        ulid.hi = hi;
+        ulid.lo = lo;
+    }
+
+    static constexpr time_t Time(const u64pair::ULID& ulid) {
+        return static_cast<time_t>(ulid.hi >> 16);
+    }
+
+    static constexpr void SetTime(u64pair::ULID& ulid, time_t timestamp) {
+        ulid.hi = (static_cast<uint64_t>(timestamp) << 16) | (ulid.hi & 0xFFFF);
+    }
+
+    static void ToBytes(const u64pair::ULID& ulid, uint8_t dst[16]) {
+        StoreBigEndian64(ulid.hi, dst);
+        StoreBigEndian64(ulid.lo, dst + 8);
+    }
+
+    static void FromBytes(const uint8_t b[16], u64pair::ULID& ulid) {
+        ulid.hi = LoadBigEndian64(b);
+        ulid.lo = LoadBigEndian64(b + 8);
+    }
+};
+
+};  // namespace ulid
+
+#if defined(__cpp_lib_format)
+/**
+ * std::format("{}", ulid) writes the 26 character encoding straight to the output.
+ * */
+template <>
+struct std::formatter<ulid::u64pair::ULID, char> : ulid::core::Formatter<ulid::u64pair::ULID> {};
+#endif
+
+#if defined(ULID_WITH_FMT)
+/**
+ * fmt::format("{}", ulid) writes the 26 character encoding straight to the output.
+ * */
+template <>
+struct fmt::formatter<ulid::u64pair::ULID> : ulid::core::Formatter<ulid::u64pair::ULID> {};
+#endif
+
+/**
+ * std::hash mixes the entropy and the timestamp, see core::Hash.
+ * */
+template <>
+struct std::hash<ulid::u64pair::ULID> : ulid::core::Hash<ulid::u64pair::ULID> {};
+
+#ifndef ULID_API_HH
+namespace ulid {
+typedef u64pair::ULID ULID;
+};  // namespace ulid
+#include "ulid_api.hh"
+#endif
+
+#endif // ULID_U64PAIR_HH
@@ -0,0 +1,306 @@
+// ulidtool converts, sorts, validates and generates ULIDs in bulk, as newline
+// separated text or as 16 byte binary records (the format of MarshalBinaryTo
+// and MappedUlidFile).
+//
+//   ulidtool gen N [-b] [out]        N new ULIDs, text or binary with -b
+//   ulidtool decode [in [out]]       text to binary
+//   ulidtool encode [in [out]]       binary to text
+//   ulidtool sort [-b] [in [out]]    sort text, or binary with -b
+//   ulidtool validate [in]           check every line is a ULID
+//
+// in and out default to stdin and stdout, "-" names them explicitly.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ulid.hh"
+
+namespace {
+
+const char* const Usage =
+    "usage: ulidtool gen N [-b] [out]\n"
+    "       ulidtool decode [in [out]]\n"
+    "       ulidtool encode [in [out]]\n"
+    "       ulidtool sort [-b] [in [out]]\n"
+    "       ulidtool validate [in]\n";
+
+const char* StatusName(ulid::Status status) {
+    switch (status) {
+    case ulid::Status::OK:
+        return "ok";
+    case ulid::Status::InvalidLength:
+        return "invalid length";
+    case ulid::Status::InvalidCharacter:
+        return "invalid character";
+    case ulid::Status::Overflow:
+        return "timestamp overflow";
+    }
+    return "unknown error";
+}
+
+int Fail(const std::string& message) {
+    std::fprintf(stderr, "ulidtool: %s\n", message.c_str());
+    return 1;
+}
+
+int Fail(const std::string& message, int error) {
+    return Fail(message + ": " + std::strerror(error));
+}
+
+// Files opens the input and output named by args, stdin and stdout by default.
+struct Files {
+    int in = STDIN_FILENO;
+    int out = STDOUT_FILENO;
+    std::string in_name = "stdin";
+    std::string out_name = "stdout";
+
+    ~Files() {
+        if (in != STDIN_FILENO) {
+            ::close(in);
+        }
+        if (out != STDOUT_FILENO) {
+            ::close(out);
+        }
+    }
+
+    bool Open(const std::vector<std::string>& args, size_t first, bool output) {
+        if (args.size() > first + (output ? 2 : 1)) {
+            std::fputs(Usage, stderr);
+            return false;
+        }
+        if (args.size() > first && args[first] != "-") {
+            in_name = args[first];
+            in = ::open(in_name.c_str(), O_RDONLY | O_CLOEXEC);
+            if (in < 0) {
+                Fail(in_name, errno);
+                return false;
+            }
+        }
+        if (output && args.size() > first + 1 && args[first + 1] != "-") {
+            out_name = args[first + 1];
+            out = ::open(out_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+            if (out < 0) {
+                Fail(out_name, errno);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Report turns the result of a conversion into an exit status. in_lines tells
+// whether the input is text, where the rejected one is line count + 1.
+int Report(const ulid::stream::Result& result, const Files& files, bool in_lines) {
+    if (result.error != 0) {
+        return Fail(files.in_name + " -> " + files.out_name, result.error);
+    }
+    if (result.status != ulid::Status::OK) {
+        if (in_lines) {
+            return Fail(files.in_name + ":" + std::to_string(result.count + 1) + ": " + StatusName(result.status));
+        }
+        return Fail(files.in_name + ": trailing partial record after " + std::to_string(result.count) + " records");
+    }
+    return 0;
+}
+
+int Gen(const std::vector<std::string>& args) {
+    std::vector<std::string> rest;
+    bool binary = false;
+    for (size_t i = 1 ; i < args.size() ; i++) {
+        if (args[i] == "-b") {
+            binary = true;
+        } else {
+            rest.push_back(args[i]);
+        }
+    }
+    if (rest.empty()) {
+        std::fputs(Usage, stderr);
+        return 2;
+    }
+
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long long n = std::strtoull(rest[0].c_str(), &end, 10);
+    if (errno != 0 || end == rest[0].c_str() || *end != '\0') {
+        return Fail("bad count " + rest[0]);
+    }
+
+    Files files;
+    if (rest.size() > 2) {
+        std::fputs(Usage, stderr);
+        return 2;
+    }
+    if (rest.size() == 2 && !files.Open({"-", rest[1]}, 0, true)) {
+        return 1;
+    }
+
+    const size_t block = ulid::stream::Block;
+    std::vector<ulid::ULID> ulids(block);
+    std::vector<uint8_t> records(16 * block);
+    std::vector<char> text(ulid::stream::LineSize * block);
+    ulid::stream::FdWriter write{files.out};
+
+    for (unsigned long long done = 0 ; done < n ; ) {
+        const size_t m = static_cast<size_t>(std::min<unsigned long long>(block, n - done));
+        ulid::GenerateBatch(ulids.data(), m);
+        for (size_t i = 0 ; i < m ; i++) {
+            ulid::MarshalBinaryTo(ulids[i], records.data() + 16 * i);
+        }
+
+        bool ok;
+        if (binary) {
+            ok = write(records.data(), 16 * m);
+        } else {
+            ulid::stream::EncodeLines(records.data(), m, text.data());
+            ok = write(text.data(), ulid::stream::LineSize * m);
+        }
+        if (!ok) {
+            return Fail(files.out_name, errno);
+        }
+        done += m;
+    }
+    return 0;
+}
+
+int Decode(const std::vector<std::string>& args) {
+    Files files;
+    if (!files.Open(args, 1, true)) {
+        return 1;
+    }
+    return Report(ulid::stream::TextToBinary(files.in, files.out), files, true);
+}
+
+int Encode(const std::vector<std::string>& args) {
+    Files files;
+    if (!files.Open(args, 1, true)) {
+        return 1;
+    }
+    return Report(ulid::stream::BinaryToText(files.in, files.out), files, false);
+}
+
+int Sort(const std::vector<std::string>& args) {
+    std::vector<std::string> rest;
+    bool binary = false;
+    for (size_t i = 0 ; i < args.size() ; i++) {
+        if (i > 0 && args[i] == "-b") {
+            binary = true;
+        } else {
+            rest.push_back(args[i]);
+        }
+    }
+
+    Files files;
+    if (!files.Open(rest, 1, true)) {
+        return 1;
+    }
+
+    // the whole input is read as records, whichever the format
+    std::vector<uint8_t> records;
+    auto append = [&](const void* src, size_t n) {
+        const uint8_t* p = static_cast<const uint8_t*>(src);
+        records.insert(records.end(), p, p + n);
+        return true;
+    };
+    ulid::stream::FdReader read{files.in};
+
+    if (binary) {
+        uint8_t chunk[1 << 16];
+        for (;;) {
+            const ptrdiff_t r = read(chunk, sizeof(chunk));
+            if (r < 0) {
+                return Fail(files.in_name, errno);
+            }
+            if (r == 0) {
+                break;
+            }
+            append(chunk, static_cast<size_t>(r));
+        }
+        if (records.size() % 16 != 0) {
+            return Fail(files.in_name + ": trailing partial record after " +
+                        std::to_string(records.size() / 16) + " records");
+        }
+    } else {
+        const int status = Report(ulid::stream::TextToBinary(read, append), files, true);
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    const size_t n = records.size() / 16;
+    std::vector<ulid::ULID> ulids(n);
+    for (size_t i = 0 ; i < n ; i++) {
+        ulid::UnmarshalBinaryFrom(records.data() + 16 * i, ulids[i]);
+    }
+    ulid::Sort(ulids.data(), n);
+    for (size_t i = 0 ; i < n ; i++) {
+        ulid::MarshalBinaryTo(ulids[i], records.data() + 16 * i);
+    }
+
+    ulid::stream::FdWriter write{files.out};
+    if (binary) {
+        if (!write(records.data(), records.size())) {
+            return Fail(files.out_name, errno);
+        }
+        return 0;
+    }
+
+    std::vector<char> text(ulid::stream::LineSize * ulid::stream::Block);
+    for (size_t i = 0 ; i < n ; i += ulid::stream::Block) {
+        const size_t m = std::min(n - i, ulid::stream::Block);
+        ulid::stream::EncodeLines(records.data() + 16 * i, m, text.data());
+        if (!write(text.data(), ulid::stream::LineSize * m)) {
+            return Fail(files.out_name, errno);
+        }
+    }
+    return 0;
+}
+
+int Validate(const std::vector<std::string>& args) {
+    Files files;
+    if (!files.Open(args, 1, false)) {
+        return 1;
+    }
+    auto discard = [](const void*, size_t) { return true; };
+    return Report(ulid::stream::TextToBinary(ulid::stream::FdReader{files.in}, discard), files, true);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    if (args.empty()) {
+        std::fputs(Usage, stderr);
+        return 2;
+    }
+
+    const std::string& command = args[0];
+    if (command == "gen") {
+        return Gen(args);
+    }
+    if (command == "decode") {
+        return Decode(args);
+    }
+    if (command == "encode") {
+        return Encode(args);
+    }
+    if (command == "sort") {
+        return Sort(args);
+    }
+    if (command == "validate") {
+        return Validate(args);
+    }
+    if (command == "-h" || command == "--help" || command == "help") {
+        std::fputs(Usage, stdout);
+        return 0;
+    }
+    std::fputs(Usage, stderr);
+    return 2;
+}